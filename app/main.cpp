@@ -3,15 +3,336 @@
 // ICS 46 Winter 2018
 // Project #4: Set the Controls for the Heart of the Sun
 //
-// You will not need to modify this file at all; it simply calls into the
-// provided code and prints any error messages that emanate from it.
+// Run with no arguments, this starts the interactive SpellCheckShell and
+// prints any error messages that emanate from it.  Run as
+//
+//     main --check FILE --dictionary DICTIONARY [--format jsonl|tsv]
+//          [--threads N] [--cache N] [--top K] [--distance D [--budget US]]
+//          [--stats STATSFILE]
+//
+// it checks FILE, or the standard input if FILE is -, without any
+// interaction, and writes one line to the standard output for every
+// misspelling: its byte offset, its line, the word and its suggestions,
+// as a JSON object per line or as tab-separated fields.  DICTIONARY is
+// either a compiled dictionary or a list of words, one per line, each
+// optionally followed by its frequency.  With --top, only the best K
+// suggestions for each misspelling are written, ranked by how small an
+// edit makes them and then by frequency.  With --distance, the suggestions
+// are every word within D edits, nearest first, which takes a list of
+// words rather than a compiled dictionary; the search for each misspelling
+// gives up after US microseconds, 1000 by default or never if 0.  With
+// --stats, the counters and latency histograms that a build with
+// WORDCHECKER_STATS=1 collects are written to STATSFILE at the end.
+//
+// Run as
+//
+//     main --compile WORDLIST DICTIONARY
+//
+// it compiles the list of words in WORDLIST into a compiled dictionary at
+// DICTIONARY, replacing it, which --check then maps instead of reading the
+// list.  Any frequencies in the list are left out.
 
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "DictionaryCompiler.hpp"
+#include "DictionaryFormat.hpp"
+#include "EditDistanceIndex.hpp"
+#include "MappedSet.hpp"
+#include "PooledStringSet.hpp"
 #include "SpellCheckShell.hpp"
+#include "Stats.hpp"
+#include "StreamChecker.hpp"
+#include "SuggestionCache.hpp"
+#include "WordChecker.hpp"
+#include "WordFrequencies.hpp"
+#include "WorkStealingPool.hpp"
+
+
+namespace
+{
+    struct BatchOptions
+    {
+        std::string input;
+        std::string dictionary;
+        std::string format = "jsonl";
+        unsigned int threads = 0;
+        std::size_t cacheSize = 65536;
+        std::size_t top = 0;
+        unsigned int distance = 0;
+        std::chrono::microseconds budget = EditDistanceIndex::DEFAULT_BUDGET;
+        std::string statsFile;
+    };
+
+
+    int usage()
+    {
+        std::cerr
+            << "usage: main --check FILE --dictionary DICTIONARY [--format jsonl|tsv]"
+            << " [--threads N] [--cache N] [--top K] [--distance D [--budget US]]"
+            << " [--stats STATSFILE]" << std::endl
+            << "       main --compile WORDLIST DICTIONARY" << std::endl;
+        return 2;
+    }
+
+
+    // readWords() calls add(word, fields) for every word in a list of words,
+    // one per line, with the word uppercased and fields holding the rest of
+    // its line.
+    template <typename Add>
+    void readWords(std::istream& file, Add add)
+    {
+        std::string line;
+        std::string word;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields{line};
+            if (!(fields >> word))
+                continue;
+
+            for (char& c : word)
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            add(word, fields);
+        }
+    }
+
+
+    // loadDictionary() maps a compiled dictionary, or reads a list of
+    // words, uppercasing them, if the file is not one.  Frequencies that
+    // follow words in a list are added to frequencies, and the words are
+    // added to index unless it is nullptr, in which case the dictionary
+    // cannot be a compiled one.
+    std::unique_ptr<Set<std::string>> loadDictionary(
+        const std::string& path, WordFrequencies& frequencies, EditDistanceIndex* index)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+            throw DictionaryFileException{"could not open dictionary: " + path};
+
+        char magic[sizeof(DictionaryFormat::MAGIC)] = {};
+        file.read(magic, sizeof(magic));
+        if (file.gcount() == sizeof(magic)
+            && std::memcmp(magic, DictionaryFormat::MAGIC, sizeof(magic)) == 0)
+        {
+            if (index != nullptr)
+                throw DictionaryFileException{"--distance needs a list of words: " + path};
+
+            return std::make_unique<MappedSet>(path);
+        }
+
+        file.clear();
+        file.seekg(0);
+        auto words = std::make_unique<PooledStringSet>();
+        readWords(file, [&](const std::string& word, std::istringstream& fields)
+        {
+            words->add(word);
+            if (index != nullptr)
+                index->add(word);
+
+            std::uint64_t frequency;
+            if (fields >> frequency)
+                frequencies.add(word, frequency);
+        });
+        return words;
+    }
+
+
+    // compileDictionary() compiles the list of words at wordList into a
+    // compiled dictionary at path.
+    int compileDictionary(const std::string& wordList, const std::string& path)
+    {
+        std::ifstream file{wordList, std::ios::binary};
+        if (!file)
+            throw DictionaryFileException{"could not open word list: " + wordList};
+
+        DictionaryCompiler compiler;
+        readWords(file, [&](const std::string& word, std::istringstream&)
+        {
+            compiler.add(word);
+        });
+        compiler.write(path);
+        return 0;
+    }
+
 
+    // writeJson() writes s as a JSON string.
+    void writeJson(std::ostream& out, const std::string& s)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        out << '"';
+        for (char c : s)
+        {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (u < 0x20)
+                out << "\\u00" << HEX[u >> 4] << HEX[u & 0xF];
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+
+    void writeJsonLine(std::ostream& out, const Misspelling& m)
+    {
+        out << "{\"offset\":" << m.offset << ",\"line\":" << m.line << ",\"word\":";
+        writeJson(out, m.word);
+        out << ",\"suggestions\":[";
+        for (std::size_t i = 0; i < m.suggestions.size(); i++)
+        {
+            if (i > 0)
+                out << ',';
+            writeJson(out, m.suggestions[i]);
+        }
+        out << "]}\n";
+    }
+
+
+    // Words never contain tabs or newlines, since the tokenizer splits on
+    // them, so the fields need no escaping.
+    void writeTsvLine(std::ostream& out, const Misspelling& m)
+    {
+        out << m.offset << '\t' << m.line << '\t' << m.word << '\t';
+        for (std::size_t i = 0; i < m.suggestions.size(); i++)
+        {
+            if (i > 0)
+                out << ',';
+            out << m.suggestions[i];
+        }
+        out << '\n';
+    }
+
+
+    int runBatch(const BatchOptions& options)
+    {
+        WordFrequencies frequencies;
+        EditDistanceIndex index;
+        std::unique_ptr<Set<std::string>> words = loadDictionary(
+            options.dictionary, frequencies, options.distance > 0 ? &index : nullptr);
+
+        WorkStealingPool pool{options.threads};
+        SuggestionCache cache{options.cacheSize};
+        WordChecker checker{*words};
+        checker.useSuggestionCache(&cache);
+        if (frequencies.size() > 0)
+            checker.useWordFrequencies(&frequencies);
+        if (options.distance > 0)
+            checker.useEditDistanceIndex(&index, options.budget);
+
+        std::ifstream file;
+        std::istream* input = &std::cin;
+        if (options.input != "-")
+        {
+            file.open(options.input, std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "ERROR: could not open " << options.input << std::endl;
+                return 1;
+            }
+            input = &file;
+        }
 
-int main()
+        std::ios::sync_with_stdio(false);
+        bool json = options.format == "jsonl";
+        StreamChecker streamChecker{checker, &pool};
+        streamChecker.limitSuggestions(options.top);
+        streamChecker.suggestWithin(options.distance);
+        streamChecker.check(*input, [&](const Misspelling& m)
+        {
+            if (json)
+                writeJsonLine(std::cout, m);
+            else
+                writeTsvLine(std::cout, m);
+        });
+
+        std::cout.flush();
+
+        if (!options.statsFile.empty() && !Stats::dumpToFile(options.statsFile))
+        {
+            std::cerr << "ERROR: could not write " << options.statsFile << std::endl;
+            return 1;
+        }
+        return std::cout ? 0 : 1;
+    }
+}
+
+
+int main(int argc, char** argv)
 {
+    if (argc > 1 && std::strcmp(argv[1], "--compile") == 0)
+    {
+        if (argc != 4)
+            return usage();
+
+        try
+        {
+            return compileDictionary(argv[2], argv[3]);
+        }
+        catch (DictionaryFileException& e)
+        {
+            std::cerr << "ERROR: " << e.reason() << std::endl;
+        }
+        return 1;
+    }
+
+    if (argc > 1)
+    {
+        BatchOptions options;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string option = argv[i];
+            if (i + 1 == argc)
+                return usage();
+
+            std::string value = argv[++i];
+            if (option == "--check")
+                options.input = value;
+            else if (option == "--dictionary")
+                options.dictionary = value;
+            else if (option == "--format" && (value == "jsonl" || value == "tsv"))
+                options.format = value;
+            else if (option == "--threads")
+                options.threads = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (option == "--cache")
+                options.cacheSize = std::strtoul(value.c_str(), nullptr, 10);
+            else if (option == "--top")
+                options.top = std::strtoul(value.c_str(), nullptr, 10);
+            else if (option == "--distance")
+                options.distance = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (option == "--budget")
+                options.budget = std::chrono::microseconds{std::strtoul(value.c_str(), nullptr, 10)};
+            else if (option == "--stats")
+                options.statsFile = value;
+            else
+                return usage();
+        }
+        if (options.input.empty() || options.dictionary.empty())
+            return usage();
+
+        try
+        {
+            return runBatch(options);
+        }
+        catch (DictionaryFileException& e)
+        {
+            std::cerr << "ERROR: " << e.reason() << std::endl;
+        }
+        catch (StreamCheckException& e)
+        {
+            std::cerr << "ERROR: " << e.reason() << std::endl;
+        }
+        return 1;
+    }
+
     try
     {
         SpellCheckShell shell;
@@ -24,4 +345,3 @@ int main()
 
     return 0;
 }
-
@@ -0,0 +1,153 @@
+// KernelCheck.cpp
+//
+// Checks that the vector code chosen at run time gives the same answers as
+// the scalar code it stands in for: EditDistanceIndex's distance kernel and
+// signature filter, and Tokenizer's classifiers.  Each is run over random
+// input from the given seed, and the program exits with a status of 1 if
+// any of them disagrees:
+//
+//     KernelCheck [seed]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "EditDistanceIndex.hpp"
+#include "EditDistanceKernels.hpp"
+#include "TokenizerKernels.hpp"
+
+
+namespace
+{
+    // The most signatures filtered in one call, as EditDistanceIndex does.
+    constexpr std::size_t MAX_SIGNATURES = 1024;
+
+
+    // kernelsAgree() runs the default distance kernel and signature filter
+    // over the given number of random batches of words and signatures,
+    // returning true if they find exactly the distances and signatures
+    // that the scalar ones do.
+    bool kernelsAgree(unsigned int batches, unsigned int seed)
+    {
+        using EditDistanceKernels::LANES;
+        const EditDistanceKernels::Dispatch scalar = EditDistanceKernels::scalar();
+        const EditDistanceKernels::Dispatch best = EditDistanceKernels::best();
+
+        // The words are drawn from a few letters, so that they are often
+        // near each other and the distances are not all about their
+        // lengths.
+        std::mt19937 random{seed};
+        auto randomWord = [&random](unsigned int length)
+        {
+            std::string word(length, 'A');
+            for (char& c : word)
+                c = static_cast<char>('A' + random() % 4);
+            return word;
+        };
+
+        std::vector<std::uint64_t> signatures;
+        std::uint32_t expectedPassed[MAX_SIGNATURES];
+        std::uint32_t actualPassed[MAX_SIGNATURES];
+        bool agree = true;
+        for (unsigned int b = 0; b < batches && agree; b++)
+        {
+            unsigned int m = 1 + random() % EditDistanceIndex::MAX_WORD_LENGTH;
+            std::string word = randomWord(m);
+            std::uint64_t peq[256] = {};
+            for (unsigned int i = 0; i < m; i++)
+                peq[static_cast<unsigned char>(word[i])] |= std::uint64_t{1} << i;
+
+            unsigned int n = 1 + random() % (EditDistanceIndex::MAX_WORD_LENGTH + 8);
+            std::string lanes[LANES];
+            const char* words[LANES];
+            for (unsigned int lane = 0; lane < LANES; lane++)
+            {
+                lanes[lane] = randomWord(n);
+                words[lane] = lanes[lane].data();
+            }
+
+            unsigned int expected[LANES];
+            unsigned int actual[LANES];
+            scalar.kernel(peq, m, words, n, expected);
+            best.kernel(peq, m, words, n, actual);
+            agree = std::equal(expected, expected + LANES, actual);
+
+            // Signatures a few bits away from the target, so that some
+            // pass, in a count that is not always a multiple of the lanes.
+            std::uint64_t target = (std::uint64_t{random()} << 32) | random();
+            signatures.resize(random() % MAX_SIGNATURES);
+            for (std::uint64_t& s : signatures)
+            {
+                s = target;
+                for (unsigned int flips = random() % 6; flips > 0; flips--)
+                    s ^= std::uint64_t{1} << (random() % 64);
+            }
+
+            unsigned int maxBits = random() % 5;
+            std::size_t expectedCount = scalar.filter(
+                signatures.data(), signatures.size(), target, maxBits, expectedPassed);
+            std::size_t actualCount = best.filter(
+                signatures.data(), signatures.size(), target, maxBits, actualPassed);
+            agree = agree && expectedCount == actualCount
+                && std::equal(expectedPassed, expectedPassed + expectedCount, actualPassed);
+        }
+
+        std::cout << "EditDistanceIndex (" << best.name << "): " << (agree ? "ok" : "MISMATCH") << std::endl;
+        return agree;
+    }
+
+
+    // classifiersAgree() runs every vector classifier that the processor
+    // supports over the given number of 64-byte blocks of random bytes,
+    // returning true if each of them uppercases and classifies every block
+    // exactly as the scalar one does.
+    bool classifiersAgree(std::size_t blocks, unsigned int seed)
+    {
+        const TokenizerKernels::Dispatch scalar = TokenizerKernels::scalar();
+
+        // Letters are drawn more often than other bytes, so that blocks
+        // hold words of every length and not only isolated letters.
+        std::mt19937 random{seed};
+        char in[64];
+        char expected[64];
+        char out[64];
+        for (const TokenizerKernels::Dispatch& vector : TokenizerKernels::vectorized())
+        {
+            for (std::size_t b = 0; b < blocks; b++)
+            {
+                for (char& c : in)
+                {
+                    unsigned int r = random();
+                    if (r % 4 == 0)
+                        c = static_cast<char>(r >> 8);
+                    else
+                        c = static_cast<char>((r % 8 < 4 ? 'a' : 'A') + (r >> 8) % 26);
+                }
+
+                std::uint64_t mask = scalar.classify(in, expected);
+                if (vector.classify(in, out) != mask || std::memcmp(out, expected, sizeof(out)) != 0)
+                {
+                    std::cout << "Tokenizer (" << vector.name << "): MISMATCH" << std::endl;
+                    return false;
+                }
+            }
+            std::cout << "Tokenizer (" << vector.name << "): ok" << std::endl;
+        }
+        return true;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int seed = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+
+    bool editDistance = kernelsAgree(10000, seed);
+    bool tokenizer = classifiersAgree(4096, seed);
+
+    return editDistance && tokenizer ? 0 : 1;
+}
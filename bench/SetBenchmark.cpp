@@ -0,0 +1,793 @@
+// SetBenchmark.cpp
+//
+// Measures each Set backend on the same words: how long they take to load,
+// how much memory they reach at their peak, how fast contains() answers
+// for words that are in the set and words that are not, and how long
+// WordChecker::findSuggestions() takes for misspellings of each length.
+// The words are generated, unless a word list is given, so the benchmark
+// needs no input files.
+//
+// Some backends are measured further.  A HashSet is also measured with its
+// hash called through a FunctionHash, and with each of the allocators in
+// Allocators.hpp, along with their counters.  An AVLSet is also loaded
+// from the words in sorted order, one at a time and in bulk, and looked up
+// once frozen.  A MappedSet is measured over the words compiled into a
+// dictionary file, which is written to the temporary directory and
+// removed again.
+//
+// Suggestions are also timed with a BloomFilter in front of a HashSet and
+// without, alongside the filter's false positive rate.  Finally, a
+// document of words and misspellings is checked with
+// WordChecker::checkDocument() on pools of 1, 2, 4 and so on up to the
+// given number of threads, one per hardware thread unless given.
+//
+//     SetBenchmark [--words N] [--word-list FILE] [--repetitions N]
+//                  [--output FILE] [--baseline FILE] [--tolerance PERCENT]
+//                  [--threads N]
+//
+// The results are written as JSON, to the standard output or to the given
+// file.  Given the JSON of an earlier run as a baseline, every measurement
+// is also compared with it, and the benchmark exits with a status of 1 if
+// any of them is worse by more than the tolerance, 10% unless given.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Allocators.hpp"
+#include "BloomFilter.hpp"
+#include "DictionaryCompiler.hpp"
+#include "FlatHashSet.hpp"
+#include "HashSet.hpp"
+#include "MappedSet.hpp"
+#include "PooledStringSet.hpp"
+#include "TrieSet.hpp"
+#include "WorkStealingPool.hpp"
+#include "WordChecker.hpp"
+
+
+// Every allocation is counted, so that the peak memory of each set can be
+// measured without asking the operating system.  Each block records its
+// own size just before the memory handed out; over-aligned blocks are
+// padded in front to their alignment, so the size is in the same place
+// relative to the memory handed out.  The counts are atomic, since
+// checkDocument() allocates on the pool's threads.  The replacements are
+// kept out of line, since GCC mistakes free() inlined into a caller of new
+// for a mismatched deallocation.
+namespace
+{
+    constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    std::atomic<std::size_t> liveBytes{0};
+    std::atomic<std::size_t> peakBytes{0};
+
+
+    void countAllocation(std::size_t size) noexcept
+    {
+        std::size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        std::size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size + HEADER_SIZE);
+    if (block == nullptr)
+        throw std::bad_alloc{};
+
+    *static_cast<std::size_t*>(block) = size;
+    countAllocation(size);
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    void* block = static_cast<char*>(p) - HEADER_SIZE;
+    liveBytes -= *static_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+__attribute__((noinline)) void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    std::size_t padding = std::max(static_cast<std::size_t>(alignment), HEADER_SIZE);
+    std::size_t total = (padding + size + padding - 1) / padding * padding;
+    void* block = std::aligned_alloc(padding, total);
+    if (block == nullptr)
+        throw std::bad_alloc{};
+
+    char* p = static_cast<char*>(block) + padding;
+    *reinterpret_cast<std::size_t*>(p - HEADER_SIZE) = size;
+    countAllocation(size);
+    return p;
+}
+
+
+__attribute__((noinline)) void operator delete(void* p, std::align_val_t alignment) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    std::size_t padding = std::max(static_cast<std::size_t>(alignment), HEADER_SIZE);
+    liveBytes -= *reinterpret_cast<std::size_t*>(static_cast<char*>(p) - HEADER_SIZE);
+    std::free(static_cast<char*>(p) - padding);
+}
+
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept
+{
+    operator delete(p, alignment);
+}
+
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(p, alignment);
+}
+
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(p, alignment);
+}
+
+
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Results maps the name of every measurement, such as
+    // "HashSet.hit_ns", to its value.
+    typedef std::map<std::string, double> Results;
+
+
+    struct Options
+    {
+        std::size_t wordCount = 200000;
+        std::string wordList;
+        int repetitions = 3;
+        std::string output;
+        std::string baseline;
+        double tolerance = 10.0;
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    };
+
+
+    // The lengths of the misspellings that suggestions are timed for, and
+    // how many misspellings of each length are timed.
+    constexpr std::size_t SHORTEST_MISSPELLING = 3;
+    constexpr std::size_t LONGEST_MISSPELLING = 14;
+    constexpr std::size_t MISSPELLINGS_PER_LENGTH = 100;
+
+
+    // Workload holds the words a set is loaded with, and the words it is
+    // then probed with.
+    struct Workload
+    {
+        std::vector<std::string> words;
+        std::vector<std::string> hits;
+        std::vector<std::string> misses;
+        std::vector<std::vector<std::string>> misspellings;
+    };
+
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+
+    std::string randomWord(std::mt19937& random)
+    {
+        // Lengths cluster around eight letters, as in English word lists.
+        std::binomial_distribution<std::size_t> length{14, 0.5};
+        std::string word(std::max<std::size_t>(2, length(random) + 1), ' ');
+        for (char& c : word)
+            c = static_cast<char>('A' + random() % 26);
+        return word;
+    }
+
+
+    std::vector<std::string> readWordList(const std::string& path)
+    {
+        std::ifstream file{path};
+        if (!file)
+        {
+            std::cerr << "ERROR: could not open " << path << std::endl;
+            std::exit(2);
+        }
+
+        std::vector<std::string> words;
+        std::string word;
+        while (file >> word)
+        {
+            for (char& c : word)
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            words.push_back(word);
+        }
+        return words;
+    }
+
+
+    Workload makeWorkload(const Options& options)
+    {
+        std::mt19937 random{21};
+        Workload w;
+
+        std::unordered_set<std::string> unique;
+        if (!options.wordList.empty())
+        {
+            for (std::string& word : readWordList(options.wordList))
+            {
+                if (unique.insert(word).second)
+                    w.words.push_back(std::move(word));
+            }
+        }
+        else
+        {
+            while (w.words.size() < options.wordCount)
+            {
+                std::string word = randomWord(random);
+                if (unique.insert(word).second)
+                    w.words.push_back(std::move(word));
+            }
+        }
+
+        // Probes come in a different order from the words, so that they
+        // do not walk the sets in the order they were built.
+        w.hits = w.words;
+        std::shuffle(w.hits.begin(), w.hits.end(), random);
+
+        while (w.misses.size() < w.words.size())
+        {
+            std::string word = randomWord(random);
+            if (unique.count(word) == 0)
+                w.misses.push_back(std::move(word));
+        }
+
+        // A misspelling is a word with one letter replaced.
+        w.misspellings.resize(LONGEST_MISSPELLING + 1);
+        for (const std::string& word : w.hits)
+        {
+            std::vector<std::string>& ofLength = w.misspellings[std::min(word.size(), LONGEST_MISSPELLING)];
+            if (word.size() < SHORTEST_MISSPELLING || word.size() > LONGEST_MISSPELLING
+                || ofLength.size() == MISSPELLINGS_PER_LENGTH)
+            {
+                continue;
+            }
+
+            std::string misspelling = word;
+            misspelling[random() % misspelling.size()] = static_cast<char>('A' + random() % 26);
+            if (unique.count(misspelling) == 0)
+                ofLength.push_back(std::move(misspelling));
+        }
+
+        return w;
+    }
+
+
+    // bestOf() runs f the given number of times and returns the shortest
+    // time it took, in milliseconds.
+    template <typename F>
+    double bestOf(int repetitions, F f)
+    {
+        double best = 0.0;
+        for (int i = 0; i < repetitions; i++)
+        {
+            Clock::time_point start = Clock::now();
+            f();
+            double elapsed = millisecondsSince(start);
+            if (i == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+
+    // probeLookups() measures contains() in the set for each of the
+    // probes, as the measurement of the given kind, returning how many of
+    // them were found.
+    template <typename SetType>
+    std::size_t probeLookups(const std::string& name, const std::string& kind, const SetType& set,
+                             const std::vector<std::string>& probes, const Options& options, Results& results)
+    {
+        std::size_t found = 0;
+        double ms = bestOf(options.repetitions, [&]
+        {
+            for (const std::string& word : probes)
+                found += set.contains(word);
+        });
+        results[name + "." + kind + "_ns"] = ms * 1e6 / probes.size();
+        results[name + "." + kind + "_per_sec"] = probes.size() / (ms / 1e3);
+        return found;
+    }
+
+
+    // probeSet() measures contains() for the hits and misses, and
+    // findSuggestions() for the misspellings of each length, in a set that
+    // already holds the words.
+    template <typename SetType>
+    void probeSet(const std::string& name, const SetType& set, const Workload& w,
+                  const Options& options, Results& results)
+    {
+        std::size_t found = probeLookups(name, "hit", set, w.hits, options, results);
+        found += probeLookups(name, "miss", set, w.misses, options, results);
+
+        WordChecker checker{set};
+        for (std::size_t length = SHORTEST_MISSPELLING; length <= LONGEST_MISSPELLING; length++)
+        {
+            const std::vector<std::string>& misspellings = w.misspellings[length];
+            if (misspellings.empty())
+                continue;
+
+            double ms = bestOf(options.repetitions, [&]
+            {
+                for (const std::string& word : misspellings)
+                    found += checker.findSuggestions(word).size();
+            });
+            results[name + ".suggest_us_length_" + std::to_string(length)] = ms * 1e3 / misspellings.size();
+        }
+
+        // Every hit must have been found, and printing the count keeps the
+        // lookups from being optimized away.
+        std::cerr << name << ": " << found << " found" << std::endl;
+    }
+
+
+    // loadSet() builds a set of the words, constructed from the given
+    // arguments, and returns it.  The load is timed once, since the set it
+    // builds is the one that is then probed; the peak is how far the heap
+    // grew meanwhile.
+    template <typename SetType, typename... Args>
+    SetType loadSet(const std::string& name, const Workload& w, Results& results, const Args&... args)
+    {
+        std::size_t before = liveBytes;
+        peakBytes = before;
+        Clock::time_point start = Clock::now();
+
+        SetType set{args...};
+        for (const std::string& word : w.words)
+            set.add(word);
+
+        results[name + ".load_ms"] = millisecondsSince(start);
+        results[name + ".peak_bytes"] = static_cast<double>(peakBytes - before);
+        return set;
+    }
+
+
+    template <typename SetType, typename... Args>
+    void benchmarkSet(const std::string& name, const Workload& w, const Options& options, Results& results,
+                      const Args&... args)
+    {
+        SetType set = loadSet<SetType>(name, w, results, args...);
+        probeSet(name, set, w, options, results);
+    }
+
+
+    // benchmarkAllocator() measures a HashSet whose memory comes from the
+    // given allocator, as benchmarkSet() does, and also reports the
+    // allocator's counters as they stand once the words are loaded.
+    template <template <typename> class Allocator>
+    void benchmarkAllocator(const std::string& name, const Workload& w, const Options& options, Results& results)
+    {
+        typedef HashSet<std::string, StringHash, Allocator<std::string>> SetType;
+        SetType set = loadSet<SetType>(name, w, results);
+
+        AllocationCounters counters = set.allocator().counters();
+        results[name + ".allocations"] = static_cast<double>(counters.allocations);
+        results[name + ".deallocations"] = static_cast<double>(counters.deallocations);
+        results[name + ".bytes_allocated"] = static_cast<double>(counters.bytesAllocated);
+        results[name + ".system_allocations"] = static_cast<double>(counters.systemAllocations);
+        results[name + ".system_bytes"] = static_cast<double>(counters.systemBytes);
+
+        probeSet(name, set, w, options, results);
+    }
+
+
+    // benchmarkAVLSet() measures what the order of the words does to an
+    // AVLSet: loading them sorted, as dictionary files are, one add() at a
+    // time and with buildFromSorted(), and looking them up once the set is
+    // frozen, to compare with the shuffled load and the tree lookups that
+    // benchmarkSet() measures.
+    void benchmarkAVLSet(const Workload& w, const Options& options, Results& results)
+    {
+        std::vector<std::string> sorted = w.words;
+        std::sort(sorted.begin(), sorted.end());
+
+        Clock::time_point start = Clock::now();
+        {
+            AVLSet<std::string> set;
+            for (const std::string& word : sorted)
+                set.add(word);
+            results["AVLSet.sorted_load_ms"] = millisecondsSince(start);
+        }
+
+        AVLSet<std::string> set;
+        results["AVLSet.build_from_sorted_ms"] = bestOf(options.repetitions, [&]
+        {
+            set.buildFromSorted(sorted.begin(), sorted.end());
+        });
+
+        start = Clock::now();
+        set.freeze();
+        results["AVLSet.freeze_ms"] = millisecondsSince(start);
+
+        std::size_t found = probeLookups("AVLSet", "frozen_hit", set, w.hits, options, results);
+        found += probeLookups("AVLSet", "frozen_miss", set, w.misses, options, results);
+        std::cerr << "AVLSet (frozen): " << found << " found" << std::endl;
+    }
+
+
+    // benchmarkMappedSet() compiles the words into a dictionary file and
+    // measures a MappedSet over it.  Its load is only the time it takes to
+    // open and map the file, and its peak only what that allocates, since
+    // the words stay in the page cache; the compile is timed on its own.
+    void benchmarkMappedSet(const Workload& w, const Options& options, Results& results)
+    {
+        std::string path = (std::filesystem::temp_directory_path() / "SetBenchmark.wcd").string();
+
+        Clock::time_point start = Clock::now();
+        DictionaryCompiler compiler;
+        for (const std::string& word : w.words)
+            compiler.add(word);
+        compiler.write(path);
+        results["MappedSet.compile_ms"] = millisecondsSince(start);
+
+        std::size_t before = liveBytes;
+        peakBytes = before;
+        start = Clock::now();
+        {
+            MappedSet set{path};
+            results["MappedSet.load_ms"] = millisecondsSince(start);
+            results["MappedSet.peak_bytes"] = static_cast<double>(peakBytes - before);
+
+            probeSet("MappedSet", set, w, options, results);
+        }
+
+        std::remove(path.c_str());
+    }
+
+
+    // benchmarkBloomFilter() measures a BloomFilter built over the words:
+    // the fraction of misses it lets through, against the fraction it
+    // expects to, and how long findSuggestions() takes on a HashSet for
+    // all the misspellings with the filter in front of it and without.
+    void benchmarkBloomFilter(const Workload& w, const Options& options, Results& results)
+    {
+        HashSet<std::string> set;
+        BloomFilter filter{static_cast<unsigned int>(w.words.size())};
+        for (const std::string& word : w.words)
+        {
+            set.add(word);
+            filter.add(word);
+        }
+
+        std::size_t passed = 0;
+        for (const std::string& word : w.misses)
+            passed += filter.mayContain(word);
+        results["bloom.fp_rate"] = static_cast<double>(passed) / w.misses.size();
+        results["bloom.expected_fp_rate"] = filter.expectedFalsePositiveRate();
+        results["bloom.bytes"] = static_cast<double>(filter.memoryUsage());
+
+        std::size_t misspellings = 0;
+        for (const std::vector<std::string>& ofLength : w.misspellings)
+            misspellings += ofLength.size();
+
+        std::size_t found = 0;
+        WordChecker checker{set};
+        auto suggest = [&](const char* kind)
+        {
+            double ms = bestOf(options.repetitions, [&]
+            {
+                for (const std::vector<std::string>& ofLength : w.misspellings)
+                {
+                    for (const std::string& word : ofLength)
+                        found += checker.findSuggestions(word).size();
+                }
+            });
+            results[std::string{"bloom.suggest_us_"} + kind] = ms * 1e3 / misspellings;
+        };
+        suggest("filter_off");
+        checker.useBloomFilter(&filter);
+        suggest("filter_on");
+
+        std::cerr << "bloom: " << found << " found, "
+                  << results["bloom.suggest_us_filter_off"] / results["bloom.suggest_us_filter_on"]
+                  << "x faster with the filter" << std::endl;
+    }
+
+
+    void writeJson(std::ostream& out, const Workload& w, const Results& results)
+    {
+        out << "{\n    \"words\": " << w.words.size() << ",\n    \"results\": {";
+
+        // The names are sorted, so "HashSet.hit_ns" and the rest of the
+        // HashSet measurements come out together under "HashSet".
+        std::string previous;
+        for (const auto& result : results)
+        {
+            std::string set = result.first.substr(0, result.first.find('.'));
+            std::string measurement = result.first.substr(set.size() + 1);
+            if (set != previous)
+            {
+                out << (previous.empty() ? "" : "\n        },") << "\n        \"" << set << "\": {";
+                previous = set;
+            }
+            else
+                out << ',';
+            out << "\n            \"" << measurement << "\": " << result.second;
+        }
+        out << (previous.empty() ? "" : "\n        }") << "\n    }\n}\n";
+    }
+
+
+    // readJson() reads the "results" of JSON written by writeJson() back
+    // into Results.  It understands only objects, strings and numbers,
+    // which is all that writeJson() writes.
+    bool readJson(const std::string& path, Results& results)
+    {
+        std::ifstream file{path};
+        std::stringstream text;
+        text << file.rdbuf();
+        if (!file)
+            return false;
+
+        std::vector<std::string> keys;
+        std::string s = text.str();
+        std::size_t i = 0;
+        while (i < s.size())
+        {
+            char c = s[i];
+            if (c == '"')
+            {
+                std::size_t end = s.find('"', i + 1);
+                if (end == std::string::npos)
+                    return false;
+                keys.push_back(s.substr(i + 1, end - i - 1));
+                i = end + 1;
+            }
+            else if (c == '}' && !keys.empty())
+            {
+                keys.pop_back();
+                i++;
+            }
+            else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
+            {
+                char* end;
+                double value = std::strtod(s.c_str() + i, &end);
+                i = end - s.c_str();
+                if (keys.size() == 3 && keys[0] == "results")
+                    results[keys[1] + "." + keys[2]] = value;
+                if (!keys.empty())
+                    keys.pop_back();
+            }
+            else
+                i++;
+        }
+        return true;
+    }
+
+
+    // compare() reports every result that is worse than the baseline by
+    // more than the tolerance, and every result in the baseline that was
+    // not measured at all, returning false if there are any.  Rates are
+    // better when higher, everything else when lower.  A baseline of zero
+    // has no percentage to compare with, so anything above it is worse
+    // unless higher is better.
+    bool compare(const Results& results, const Results& baseline, double tolerance)
+    {
+        bool passed = true;
+        for (const auto& expected : baseline)
+        {
+            const std::string& name = expected.first;
+            auto actual = results.find(name);
+            if (actual == results.end())
+            {
+                std::cerr << "MISSING " << name << ": in the baseline but not measured" << std::endl;
+                passed = false;
+                continue;
+            }
+
+            bool higherIsBetter = name.size() >= 8 && name.compare(name.size() - 8, 8, "_per_sec") == 0;
+            if (expected.second == 0.0)
+            {
+                if (!higherIsBetter && actual->second > 0.0)
+                {
+                    std::cerr << "REGRESSION " << name << ": 0 -> " << actual->second << std::endl;
+                    passed = false;
+                }
+                continue;
+            }
+
+            double change = (actual->second - expected.second) / expected.second * 100.0;
+            if (higherIsBetter)
+                change = -change;
+
+            if (change > tolerance)
+            {
+                std::cerr << "REGRESSION " << name << ": " << expected.second << " -> "
+                          << actual->second << " (" << change << "% worse)" << std::endl;
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+
+    // benchmarkCheckDocument() measures WordChecker::checkDocument() on a
+    // HashSet with pools of 1, 2, 4 and so on up to the given number of
+    // threads.  The document is the misspellings mixed in among ten times
+    // as many words, so that most tokens are cheap and a few are not.
+    void benchmarkCheckDocument(const Workload& w, const Options& options, Results& results)
+    {
+        HashSet<std::string> set;
+        for (const std::string& word : w.words)
+            set.add(word);
+
+        std::vector<std::string> tokens;
+        for (const std::vector<std::string>& ofLength : w.misspellings)
+            tokens.insert(tokens.end(), ofLength.begin(), ofLength.end());
+        std::size_t words = std::min(w.hits.size(), tokens.size() * 10);
+        tokens.insert(tokens.end(), w.hits.begin(), w.hits.begin() + words);
+
+        std::mt19937 random{8};
+        std::shuffle(tokens.begin(), tokens.end(), random);
+
+        WordChecker checker{set};
+        std::size_t found = 0;
+        for (unsigned int threads = 1; ; threads = std::min(threads * 2, options.threads))
+        {
+            WorkStealingPool pool{threads};
+            double ms = bestOf(options.repetitions, [&]
+            {
+                found += checker.checkDocument(tokens, pool).size();
+            });
+            results["checkDocument.threads_" + std::to_string(threads) + "_tokens_per_sec"]
+                = tokens.size() / (ms / 1e3);
+
+            if (threads == options.threads)
+                break;
+        }
+
+        std::cerr << "checkDocument: " << found << " checked" << std::endl;
+    }
+
+
+    Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            std::string option = argv[i];
+            std::string value = argv[i+1];
+            if (option == "--words")
+                options.wordCount = std::strtoul(value.c_str(), nullptr, 10);
+            else if (option == "--word-list")
+                options.wordList = value;
+            else if (option == "--repetitions")
+                options.repetitions = std::max(1, std::atoi(value.c_str()));
+            else if (option == "--output")
+                options.output = value;
+            else if (option == "--baseline")
+                options.baseline = value;
+            else if (option == "--tolerance")
+                options.tolerance = std::strtod(value.c_str(), nullptr);
+            else if (option == "--threads")
+                options.threads = std::max(1ul, std::strtoul(value.c_str(), nullptr, 10));
+            else
+            {
+                std::cerr << "unknown option: " << option << std::endl;
+                std::exit(2);
+            }
+        }
+        return options;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    Options options = parseOptions(argc, argv);
+    Workload w = makeWorkload(options);
+
+    Results results;
+    benchmarkSet<HashSet<std::string>>("HashSet", w, options, results);
+
+    // The same hash called through a std::function, to show what a hash
+    // chosen at run time costs.
+    FunctionHash<std::string> functionHash{[](const std::string& s)
+    {
+        return static_cast<unsigned int>(StringHash{}(s));
+    }};
+    benchmarkSet<HashSet<std::string, FunctionHash<std::string>>>(
+        "HashSetFunctionHash", w, options, results, functionHash);
+
+    benchmarkAllocator<CountingAllocator>("HashSetCounting", w, options, results);
+    benchmarkAllocator<ArenaAllocator>("HashSetArena", w, options, results);
+    benchmarkAllocator<PoolAllocator>("HashSetPool", w, options, results);
+
+    benchmarkSet<FlatHashSet<std::string>>("FlatHashSet", w, options, results);
+    benchmarkSet<AVLSet<std::string>>("AVLSet", w, options, results);
+    benchmarkAVLSet(w, options, results);
+    benchmarkSet<PooledStringSet>("PooledStringSet", w, options, results);
+    benchmarkSet<TrieSet>("TrieSet", w, options, results);
+    benchmarkMappedSet(w, options, results);
+    benchmarkBloomFilter(w, options, results);
+    benchmarkCheckDocument(w, options, results);
+
+    if (options.output.empty())
+        writeJson(std::cout, w, results);
+    else
+    {
+        std::ofstream file{options.output};
+        writeJson(file, w, results);
+    }
+
+    if (!options.baseline.empty())
+    {
+        Results baseline;
+        if (!readJson(options.baseline, baseline))
+        {
+            std::cerr << "ERROR: could not read baseline " << options.baseline << std::endl;
+            return 2;
+        }
+        if (!compare(results, baseline, options.tolerance))
+            return 1;
+    }
+
+    return 0;
+}
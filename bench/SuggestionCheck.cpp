@@ -0,0 +1,151 @@
+// SuggestionCheck.cpp
+//
+// Checks that the other ways of finding suggestions give the same answers
+// as generating and probing candidates in a HashSet: looking up near words
+// in a DeletionIndex, and searching a TrieSet, both as a plain trie and
+// once minimized.  Each finds suggestions for the same misspellings of
+// random words from the given seed, and the program exits with a status of
+// 1 if any of them finds a different set of suggestions for any of them:
+//
+//     SuggestionCheck [seed]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "DeletionIndex.hpp"
+#include "HashSet.hpp"
+#include "TrieSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // The words are drawn from a few letters, so that most of them have
+    // several others within one edit, including doubled letters, which
+    // different edits turn into the same word.
+    std::string randomWord(std::mt19937& random)
+    {
+        std::string word(1 + random() % 10, 'A');
+        for (char& c : word)
+            c = static_cast<char>('A' + random() % 5);
+        return word;
+    }
+
+
+    // misspell() applies one random swap, insertion, deletion or
+    // replacement to the word, from any letter of the alphabet.
+    void misspell(std::string& word, std::mt19937& random)
+    {
+        char letter = static_cast<char>('A' + random() % 26);
+        std::size_t i = random() % word.size();
+        switch (random() % 4)
+        {
+        case 0:
+            if (i + 1 < word.size())
+                std::swap(word[i], word[i+1]);
+            break;
+        case 1:
+            word.insert(word.begin() + random() % (word.size() + 1), letter);
+            break;
+        case 2:
+            if (word.size() > 1)
+                word.erase(word.begin() + i);
+            break;
+        default:
+            word[i] = letter;
+            break;
+        }
+    }
+
+
+    // sameSuggestions() returns true if the checker finds the same
+    // suggestions as the expected one for every probe, in any order and
+    // counting each suggestion once, reporting the first probe for which
+    // it does not.
+    bool sameSuggestions(
+        const std::string& name, const WordChecker& expected, const WordChecker& actual,
+        const std::vector<std::string>& probes)
+    {
+        auto suggestionsFrom = [](const WordChecker& checker, const std::string& word)
+        {
+            std::vector<std::string> suggestions = checker.findSuggestions(word);
+            std::sort(suggestions.begin(), suggestions.end());
+            suggestions.erase(std::unique(suggestions.begin(), suggestions.end()), suggestions.end());
+            return suggestions;
+        };
+
+        for (const std::string& word : probes)
+        {
+            if (suggestionsFrom(expected, word) != suggestionsFrom(actual, word))
+            {
+                std::cout << name << ": MISMATCH for " << word << std::endl;
+                return false;
+            }
+        }
+
+        std::cout << name << ": ok" << std::endl;
+        return true;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int seed = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    std::mt19937 random{seed};
+
+    HashSet<std::string> hashSet;
+    TrieSet trieSet;
+    DeletionIndex index;
+    std::vector<std::string> words;
+    for (unsigned int i = 0; i < 5000; i++)
+    {
+        std::string word = randomWord(random);
+        hashSet.add(word);
+        trieSet.add(word);
+        index.add(word);
+        words.push_back(word);
+    }
+
+    // The probes are words in the set, misspellings of them one and two
+    // edits away, and words that may be nowhere near any of them.
+    std::vector<std::string> probes;
+    for (unsigned int i = 0; i < 20000; i++)
+    {
+        std::string word = words[random() % words.size()];
+        switch (i % 4)
+        {
+        case 0:
+            break;
+        case 1:
+            misspell(word, random);
+            break;
+        case 2:
+            misspell(word, random);
+            misspell(word, random);
+            break;
+        default:
+            word = randomWord(random);
+            break;
+        }
+        probes.push_back(word);
+    }
+
+    WordChecker probing{hashSet};
+    WordChecker indexed{hashSet};
+    indexed.useDeletionIndex(&index);
+    bool deletionIndex = sameSuggestions("DeletionIndex", probing, indexed, probes);
+
+    WordChecker trie{trieSet};
+    bool plainTrie = sameSuggestions("TrieSet", probing, trie, probes);
+
+    TrieSet minimizedSet = trieSet;
+    minimizedSet.minimize();
+    WordChecker minimized{minimizedSet};
+    bool minimizedTrie = sameSuggestions("TrieSet (minimized)", probing, minimized, probes);
+
+    return deletionIndex && plainTrie && minimizedTrie ? 0 : 1;
+}
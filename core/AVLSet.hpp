@@ -3,15 +3,43 @@
 #define AVLSET_HPP
 
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Prefetch.hpp"
 #include "Set.hpp"
-
-	
-template <typename T>
+#include "SetVersion.hpp"
+
+
+
+// The nodes of an AVLSet are kept in one contiguous array and refer to
+// each other by index, so the tree is allocated in a few large blocks and
+// a copy of it is a copy of that array.
+//
+// A set that will not change any more can be frozen, which lays its
+// elements out as an implicit tree in one array in breadth-first
+// (Eytzinger) order: the children of the element at index k are at 2k and
+// 2k+1.  Searching that array needs no child pointers at all, and the next
+// few levels of the search can be prefetched before they are reached.
+//
+// Both arrays take their memory from the Allocator, rebound to their
+// element types, so an AVLSet can share an arena or pool from
+// Allocators.hpp with other sets.  Since the nodes are already contiguous,
+// this decides where the tree lives rather than how often it allocates.
+template <typename T, typename Allocator = std::allocator<T>>
 class AVLSet : public Set<T>
 {
 public:
-    // Initializes an AVLSet to be empty.
-    AVLSet();
+    // Initializes an AVLSet to be empty, taking its memory from the given
+    // allocator.
+    explicit AVLSet(const Allocator& allocator = Allocator());
+
+    // Initializes an AVLSet to contain the elements in the range from first
+    // up to last.  If they are already in increasing order, the tree is
+    // built directly in linear time instead of one element at a time.
+    template <typename Iterator>
+    AVLSet(Iterator first, Iterator last, const Allocator& allocator = Allocator());
 
     // Cleans up the AVLSet so that it leaks no memory.
     virtual ~AVLSet() noexcept;
@@ -45,14 +73,55 @@ public:
     virtual bool contains(const T& element) const override;
 
 
+    // This version of contains() accepts any key that can be ordered
+    // against a T, such as a std::string_view for an AVLSet<std::string>,
+    // without first converting it to a T.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
 
+    // version() returns a number that changes whenever the set's elements
+    // might have (see SetVersion.hpp).  Freezing the set does not change
+    // it.
+    unsigned long long version() const noexcept;
+
+
     // height() returns the height of the AVL tree.
     int height() const;
 
 
+    // buildFromSorted() replaces the contents of the set with the elements
+    // in the range from first up to last, which must be in non-decreasing
+    // order, building a perfectly balanced tree in linear time.
+    template <typename Iterator>
+    void buildFromSorted(Iterator first, Iterator last);
+
+
+    // freeze() lays the set out in its frozen, array-based form.  The set
+    // behaves the same afterward; adding to it unfreezes it again, which
+    // costs a rebuild of the tree.
+    void freeze();
+
+
+    // isFrozen() returns true if the set is in its frozen form.
+    bool isFrozen() const noexcept;
+
+
+    // allocator() returns a copy of the allocator that the set's memory
+    // comes from.
+    Allocator allocator() const;
+
+
     // preorder() visits all of the elements in the AVL tree in preorder,
     // calling the given "visit" function and passing it each element.
     void preorder(std::function<void(const T&)> visit) const;
@@ -69,406 +138,527 @@ public:
 
 
 private:
+    // The index NONE stands for a missing child, or for the root of an
+    // empty tree.
+    static constexpr unsigned int NONE = ~0u;
+
+    // No AVL tree with fewer than 2^32 nodes is taller than this, so the
+    // path from the root to any node fits in an array of this size.
+    static constexpr unsigned int MAX_HEIGHT = 64;
+
     struct Node
     {
-        Node* left = nullptr;
+        unsigned int left = NONE;
         T value;
         int height = 0;
-        Node* right =  nullptr;
+        unsigned int right = NONE;
     };
-	
-    Node* root;
-
-	void addNode(Node* curr, const T& element);
-    void copy(Node* copyNode, const Node* originNode);
-	void removeAll(Node* curr);
-	bool containsR(const T& element,Node* curr) const;
-    Node* createNode(const T& element);
-    int nodeHeight(Node* node) const;
-	void inorderR(std::function<void(const T&)> visit, Node* curr) const;
-	void preorderR(std::function<void(const T&)> visit, Node* curr) const;
-	void postorderR(std::function<void(const T&)> visit, Node* curr) const;
-	Node* llRotation(Node* unbalanced);
-    Node* rrRotation(Node* unbalanced);
-    Node* rlRotation(Node* unbalanced);
-    Node* lrRotation(Node* unbalanced);
-	bool balanceVal(Node* node) const;
-	int checkBalance(Node* node) const;
-    void balance(Node* parent, int bal);
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node> NodeAllocator;
+
+    std::vector<Node, NodeAllocator> nodes;
+    unsigned int root;
+
+    // While frozen, the elements are in frozen instead of nodes, starting
+    // at index 1 so that the children of k are always 2k and 2k+1.
+    std::vector<T, Allocator> frozen;
+
+    SetVersion contents;
+
+    int nodeHeight(unsigned int node) const;
+    void updateHeight(unsigned int node);
+    unsigned int rebalance(unsigned int node);
+    unsigned int rotateLeft(unsigned int node);
+    unsigned int rotateRight(unsigned int node);
+    unsigned int buildR(unsigned int first, unsigned int last);
+    template <typename Iterator>
+    void fillFrozenR(unsigned int k, Iterator& next);
+    void thaw();
+    unsigned int rootOf() const;
+    unsigned int leftOf(unsigned int curr) const;
+    unsigned int rightOf(unsigned int curr) const;
+    const T& valueOf(unsigned int curr) const;
+    void inorderR(std::function<void(const T&)>& visit, unsigned int curr) const;
+    void preorderR(std::function<void(const T&)>& visit, unsigned int curr) const;
+    void postorderR(std::function<void(const T&)>& visit, unsigned int curr) const;
 };
 
 
-template <typename T>
-AVLSet<T>::AVLSet() : root{nullptr}
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>::AVLSet(const Allocator& allocator)
+    : nodes(NodeAllocator(allocator)), root{NONE}, frozen(allocator)
 {
 }
 
 
-template <typename T>
-AVLSet<T>::~AVLSet() noexcept
+template <typename T, typename Allocator>
+template <typename Iterator>
+AVLSet<T, Allocator>::AVLSet(Iterator first, Iterator last, const Allocator& allocator)
+    : nodes(NodeAllocator(allocator)), root{NONE}, frozen(allocator)
 {
-    if (root != nullptr)
-        removeAll(root);
+    std::vector<T> elements(first, last);
+    bool sorted = true;
+    for (std::size_t i = 1; sorted && i < elements.size(); i++)
+        sorted = !(elements[i] < elements[i-1]);
+
+    if (sorted)
+        buildFromSorted(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+    else
+    {
+        for (const T& element : elements)
+            add(element);
+    }
 }
 
 
-template <typename T>
-AVLSet<T>::AVLSet(const AVLSet& s)
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>::~AVLSet() noexcept
 {
-    if(s.root != nullptr)
-	    copy(root, s.root);
-    else
-        root = nullptr;
 }
 
 
-template <typename T>
-AVLSet<T>::AVLSet(AVLSet&& s) noexcept
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>::AVLSet(const AVLSet& s)
+    : nodes{s.nodes}, root{s.root}, frozen{s.frozen}
 {
-    if (s.root != nullptr)
-        std::swap(root, s.root);
-    else
-        root = nullptr;
 }
 
 
-template <typename T>
-AVLSet<T>& AVLSet<T>::operator=(const AVLSet& s)
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>::AVLSet(AVLSet&& s) noexcept
+    : nodes{std::move(s.nodes)}, root{s.root}, frozen{std::move(s.frozen)}
 {
-    if (this != &s && s.root != nullptr)
+    s.nodes.clear();
+    s.frozen.clear();
+    s.root = NONE;
+    s.contents.bump();
+}
+
+
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>& AVLSet<T, Allocator>::operator=(const AVLSet& s)
+{
+    if (this != &s)
     {
-        Node* newRoot;
-        copy(newRoot, s.root);
-        removeAll(root);
-        root = newRoot;
+        nodes = s.nodes;
+        root = s.root;
+        frozen = s.frozen;
+        contents.bump();
     }
     return *this;
 }
 
 
-template <typename T>
-AVLSet<T>& AVLSet<T>::operator=(AVLSet&& s) noexcept
+template <typename T, typename Allocator>
+AVLSet<T, Allocator>& AVLSet<T, Allocator>::operator=(AVLSet&& s) noexcept
 {
+    std::swap(nodes, s.nodes);
     std::swap(root, s.root);
+    std::swap(frozen, s.frozen);
+    contents.bump();
+    s.contents.bump();
     return *this;
 }
 
 
-template <typename T>
-bool AVLSet<T>::isImplemented() const noexcept
+template <typename T, typename Allocator>
+bool AVLSet<T, Allocator>::isImplemented() const noexcept
 {
     return true;
 }
 
 
-template <typename T>
-void AVLSet<T>::add(const T& element)
-{	
-	if(root == nullptr)
-        root = createNode(element);
-    else
- 	{
-		Node* curr = root;
-		addNode(curr, element);
-	}  		 
-}
-
-template <typename T>
-void AVLSet<T>::addNode(Node* curr, const T& element)
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::add(const T& element)
 {
-	if(curr->value < element)
-	{
-		if(curr->right == nullptr)
-		{
-			curr->right = createNode(element);
-            curr->height = 1;
+    if (isFrozen())
+    {
+        if (contains(element))
             return;
-		}
-		else
-			addNode(curr->right,element);
-            curr->height = nodeHeight(curr);
-	}
-	else if(curr->value > element)
-	{
-		if(curr->left == nullptr)
-		{
-			curr->left = createNode(element);
-			curr->height = 1;
+        thaw();
+    }
+
+    // Walk down to where the element belongs, remembering the path so
+    // that the heights along it can be fixed on the way back up.
+    unsigned int path[MAX_HEIGHT];
+    unsigned int depth = 0;
+    for (unsigned int curr = root; curr != NONE; )
+    {
+        path[depth++] = curr;
+        if (nodes[curr].value < element)
+            curr = nodes[curr].right;
+        else if (element < nodes[curr].value)
+            curr = nodes[curr].left;
+        else
             return;
-		}
-		else
-			addNode(curr->left,element);
-            curr->height = nodeHeight(curr);
-	}
-	else
-		return;
-    /*
-	if(curr->right != nullptr){
-		int bal = checkBalance(curr->right);
-        if (bal != 0)
-            balance(curr, bal);
     }
-	if(curr->left != nullptr)
+
+    Node node;
+    node.value = element;
+    nodes.push_back(std::move(node));
+    unsigned int child = nodes.size() - 1;
+    contents.bump();
+
+    // Rebalancing may replace the root of each subtree on the path, so the
+    // link from its parent is rewritten at every step.
+    while (depth > 0)
     {
-		int bal = checkBalance(curr->left);
-        if (bal != 0)
-            balance(curr, bal);
+        unsigned int parent = path[--depth];
+        if (nodes[parent].value < nodes[child].value)
+            nodes[parent].right = child;
+        else
+            nodes[parent].left = child;
+
+        int oldHeight = nodes[parent].height;
+        child = rebalance(parent);
+        if (child == parent && nodes[parent].height == oldHeight)
+            return;
     }
-    curr->height = nodeHeight(curr);
-    */
+    root = child;
 }
 
 
-template <typename T>
-bool AVLSet<T>::contains(const T& element) const
+template <typename T, typename Allocator>
+bool AVLSet<T, Allocator>::contains(const T& element) const
 {
-    if (root == nullptr)
-        return false;
-	Node* curr = root;
-	return containsR(element,curr);
+    return contains<T>(element);
 }
 
 
-template <typename T>
-bool AVLSet<T>::containsR(const T& element,Node* curr) const
-{   
-    if(curr->value < element)
-    {   
-        if(curr->right == nullptr)
-            return false;
-        else
-            return containsR(element, curr->right);
+template <typename T, typename Allocator>
+template <typename K>
+bool AVLSet<T, Allocator>::contains(const K& key) const
+{
+    if (isFrozen())
+    {
+        // Each step moves to child 2k or 2k+1 depending only on the
+        // comparison, so the loop body has no branch to mispredict.  Once k
+        // runs off the bottom, the last step that went left is undone by
+        // stripping the trailing ones, leaving the smallest element that
+        // is not less than the key.
+        std::size_t n = frozen.size() - 1;
+        std::size_t k = 1;
+        while (k <= n)
+        {
+            prefetch(frozen.data() + (k * 4 <= n ? k * 4 : 0));
+            k = 2 * k + (frozen[k] < key);
+        }
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+        return k != 0 && !(key < frozen[k]);
     }
-    else if(curr->value > element)
-    {   
-        if(curr->left == nullptr)
-            return false;
+
+    unsigned int curr = root;
+    while (curr != NONE)
+    {
+        if (nodes[curr].value < key)
+            curr = nodes[curr].right;
+        else if (key < nodes[curr].value)
+            curr = nodes[curr].left;
         else
-            return containsR(element,curr->left);
+            return true;
     }
-    else
-        return true;
+    return false;
 }
 
 
-template <typename T>
-unsigned int AVLSet<T>::size() const noexcept
+template <typename T, typename Allocator>
+template <typename K>
+void AVLSet<T, Allocator>::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
 {
-    return 0;
+    found.assign(keys.size(), false);
+    for (std::size_t i = 0; i < keys.size(); i++)
+        found[i] = contains<K>(keys[i]);
 }
 
 
-template <typename T>
-int AVLSet<T>::height() const
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::size() const noexcept
 {
-    if (root == nullptr)
-        return -1;
-    return root->height;
+    if (isFrozen())
+        return frozen.size() - 1;
+    return nodes.size();
 }
 
 
-template <typename T>
-void AVLSet<T>::preorder(std::function<void(const T&)> visit) const
+template <typename T, typename Allocator>
+unsigned long long AVLSet<T, Allocator>::version() const noexcept
 {
-	if (root != nullptr)
-		preorderR(visit,root);
+    return contents.get();
 }
 
 
-template <typename T>
-void AVLSet<T>::preorderR(std::function<void(const T&)> visit, Node* curr) const
+template <typename T, typename Allocator>
+int AVLSet<T, Allocator>::height() const
 {
-	visit(curr->value);
-   	if(curr->left != nullptr)
-        preorderR(visit,curr->left);
-    if(curr->right != nullptr)
-        preorderR(visit,curr->right);
+    if (isFrozen())
+    {
+        int levels = 0;
+        for (std::size_t n = frozen.size() - 1; n > 0; n >>= 1)
+            levels++;
+        return levels - 1;
+    }
+    return nodeHeight(root);
 }
 
 
-template <typename T>
-void AVLSet<T>::inorder(std::function<void(const T&)> visit) const
+template <typename T, typename Allocator>
+template <typename Iterator>
+void AVLSet<T, Allocator>::buildFromSorted(Iterator first, Iterator last)
 {
-	if (root != nullptr)
-        inorderR(visit,root);
+    // The elements go into the array in order, skipping duplicates, and
+    // then each range's middle element becomes the root of that range.
+    frozen.clear();
+    nodes.clear();
+    for (; first != last; ++first)
+    {
+        if (!nodes.empty() && !(nodes.back().value < *first))
+            continue;
+        Node node;
+        node.value = *first;
+        nodes.push_back(std::move(node));
+    }
+    root = buildR(0, nodes.size());
+    contents.bump();
 }
 
 
-template <typename T>
-void AVLSet<T>::inorderR(std::function<void(const T&)> visit, Node* curr) const
-{  
-    if(curr->left != nullptr)
-        inorderR(visit,curr->left);
-	visit(curr->value);
-    if(curr->right != nullptr)
-        inorderR(visit,curr->right);
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::freeze()
+{
+    if (isFrozen())
+        return;
+
+    // Visiting the implicit tree's positions in order and handing them
+    // the elements in sorted order puts each element where a search of
+    // the array expects it.
+    std::vector<T> sorted;
+    sorted.reserve(nodes.size());
+    inorder([&](const T& element) { sorted.push_back(element); });
+
+    std::vector<T, Allocator> layout(sorted.size() + 1, T(), frozen.get_allocator());
+    frozen.swap(layout);
+    auto next = std::make_move_iterator(sorted.begin());
+    fillFrozenR(1, next);
+
+    nodes.clear();
+    nodes.shrink_to_fit();
+    root = NONE;
 }
 
 
-template <typename T>
-void AVLSet<T>::postorder(std::function<void(const T&)> visit) const
+template <typename T, typename Allocator>
+bool AVLSet<T, Allocator>::isFrozen() const noexcept
 {
-	if (root != nullptr)
-        postorderR(visit,root);
+    return !frozen.empty();
 }
 
 
-template <typename T>
-void AVLSet<T>::postorderR(std::function<void(const T&)> visit, Node* curr) const
+template <typename T, typename Allocator>
+Allocator AVLSet<T, Allocator>::allocator() const
 {
-	if(curr->left != nullptr)
-        postorderR(visit,curr->left);
-    if(curr->right != nullptr)
-        postorderR(visit,curr->right);
-	visit(curr->value);
+    return frozen.get_allocator();
 }
 
 
-template <typename T>
-typename AVLSet<T>::Node* AVLSet<T>::createNode(const T& element)
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::preorder(std::function<void(const T&)> visit) const
 {
-    Node* new_ptr = nullptr;
-    try
-    {
-        new_ptr = new Node;
-        new_ptr->value = element;
-    }catch(std::bad_alloc &)
-    {
-        delete new_ptr;
-        throw;
-    }
-    return new_ptr; 
+    preorderR(visit, rootOf());
 }
 
 
-template <typename T>
-void AVLSet<T>::copy(Node* copyNode, const Node* originNode)
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::preorderR(std::function<void(const T&)>& visit, unsigned int curr) const
 {
-    copyNode = createNode(originNode->value);
-    copyNode->height = originNode->height;
-    if(originNode->left != nullptr)
-        copy(copyNode->left, originNode->left);
-    if(originNode->right != nullptr)
-        copy(copyNode->right, originNode->right);
+    if (curr == NONE)
+        return;
+    visit(valueOf(curr));
+    preorderR(visit, leftOf(curr));
+    preorderR(visit, rightOf(curr));
 }
 
 
-template <typename T>
-void AVLSet<T>::removeAll(Node* curr)
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::inorder(std::function<void(const T&)> visit) const
 {
-    if(curr->left != nullptr)
-        removeAll(curr->left);
-    if(curr->right != nullptr)
-        removeAll(curr->right);
-    delete curr;
+    inorderR(visit, rootOf());
 }
 
 
-template <typename T>
-int AVLSet<T>::nodeHeight(Node* node) const
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::inorderR(std::function<void(const T&)>& visit, unsigned int curr) const
 {
-    if (node->right == nullptr && node->left == nullptr)
-        return 0;
-    else if (node->right != nullptr && node-> left == nullptr)
-        return node->right->height+1;
-    else if (node->right == nullptr && node-> left != nullptr)
-        return node->left->height+1;
-    else
-    {
-        if (node->right->height > node->left->height)
-            return node->right->height+1;
-        else
-            return node->left->height+1;
-    }
+    if (curr == NONE)
+        return;
+    inorderR(visit, leftOf(curr));
+    visit(valueOf(curr));
+    inorderR(visit, rightOf(curr));
+}
+
+
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::postorder(std::function<void(const T&)> visit) const
+{
+    postorderR(visit, rootOf());
+}
+
+
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::postorderR(std::function<void(const T&)>& visit, unsigned int curr) const
+{
+    if (curr == NONE)
+        return;
+    postorderR(visit, leftOf(curr));
+    postorderR(visit, rightOf(curr));
+    visit(valueOf(curr));
+}
+
+
+template <typename T, typename Allocator>
+int AVLSet<T, Allocator>::nodeHeight(unsigned int node) const
+{
+    if (node == NONE)
+        return -1;
+    return nodes[node].height;
+}
+
+
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::updateHeight(unsigned int node)
+{
+    int left = nodeHeight(nodes[node].left);
+    int right = nodeHeight(nodes[node].right);
+    nodes[node].height = (left > right ? left : right) + 1;
 }
 
-/*
-template <typename T>
-int AVLSet<T>::checkBalance(Node* node) const
+
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::rebalance(unsigned int node)
 {
-    int balance = balanceVal(node);
-    if(balance == 2)
+    // Returns the root of the subtree after fixing its height and, if its
+    // sides now differ in height by two, rotating it back into balance.
+    updateHeight(node);
+    int balance = nodeHeight(nodes[node].left) - nodeHeight(nodes[node].right);
+
+    if (balance > 1)
     {
-        balance = balanceVal(node->left);
-        if(balance == 2)
-            return 1; // ll
-        else if(balance == -2)
-            return 2; // lr
+        unsigned int left = nodes[node].left;
+        if (nodeHeight(nodes[left].left) < nodeHeight(nodes[left].right))
+            nodes[node].left = rotateLeft(left);
+        return rotateRight(node);
     }
-    else if(balance == -2)
+    else if (balance < -1)
     {
-        balance = balanceVal(node->left);
-        if(balance == 2)
-            return 3; // rl
-        else if(balance == -2)
-            return 4; // rr
+        unsigned int right = nodes[node].right;
+        if (nodeHeight(nodes[right].right) < nodeHeight(nodes[right].left))
+            nodes[node].right = rotateRight(right);
+        return rotateLeft(node);
     }
-    return 0;
+    return node;
 }
 
 
-template <typename T>
-bool AVLSet<T>::balanceVal(Node* node) const
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::rotateLeft(unsigned int node)
 {
-    return nodeHeight(node->left) - nodeHeight(node->right);
+    unsigned int pivot = nodes[node].right;
+    nodes[node].right = nodes[pivot].left;
+    nodes[pivot].left = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
 }
 
 
-template <typename T>
-void AVLSet<T>::balance(Node* parent, int bal)
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::rotateRight(unsigned int node)
 {
-    if (bal == 1)
-        llRotation(parent);
-    else if (bal == 2)
-        lrRotation(parent);
-    else if (bal == 3)
-        rlRotation(parent);
-    else
-        rrRotation(parent);
+    unsigned int pivot = nodes[node].left;
+    nodes[node].left = nodes[pivot].right;
+    nodes[pivot].right = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
 }
 
 
-template <typename T>
-typename AVLSet<T>::Node* AVLSet<T>::llRotation(Node* parent)
+
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::buildR(unsigned int first, unsigned int last)
 {
-    Node* temp;
-    temp = parent->left;
-    parent->left = temp->right;
-    temp->right = parent;
-   	return temp; 
+    if (first == last)
+        return NONE;
+
+    unsigned int middle = first + (last - first) / 2;
+    nodes[middle].left = buildR(first, middle);
+    nodes[middle].right = buildR(middle + 1, last);
+    updateHeight(middle);
+    return middle;
 }
 
 
-template <typename T>
-typename AVLSet<T>::Node* AVLSet<T>::rrRotation(Node* parent)
+template <typename T, typename Allocator>
+template <typename Iterator>
+void AVLSet<T, Allocator>::fillFrozenR(unsigned int k, Iterator& next)
 {
-	Node* temp;
-    temp = parent->right;
-    parent->right = temp->left;
-    temp->left = parent;
-    return temp;
+    if (k >= frozen.size())
+        return;
+    fillFrozenR(2 * k, next);
+    frozen[k] = *next++;
+    fillFrozenR(2 * k + 1, next);
 }
 
 
-template <typename T>
-typename AVLSet<T>::Node* AVLSet<T>::lrRotation(Node* parent)
+template <typename T, typename Allocator>
+void AVLSet<T, Allocator>::thaw()
 {
-	Node* temp;
-    temp = parent->left;
-    parent->left = rrRotation(temp);
-    return llRotation(parent);
+    std::vector<T> sorted;
+    sorted.reserve(frozen.size());
+    inorder([&](const T& element) { sorted.push_back(element); });
+    buildFromSorted(std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()));
 }
 
 
-template <typename T>
-typename AVLSet<T>::Node* AVLSet<T>::rlRotation(Node* parent)
+// While the set is frozen, the traversals walk the implicit tree in the
+// frozen array, whose positions run from 1 and whose missing children are
+// the positions past its end.
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::rootOf() const
 {
-	Node* temp;
-    temp = parent->right;
-    parent->right = llRotation(temp);
-    return rrRotation(parent);
+    if (isFrozen())
+        return frozen.size() > 1 ? 1 : NONE;
+    return root;
+}
+
+
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::leftOf(unsigned int curr) const
+{
+    if (isFrozen())
+        return 2 * curr < frozen.size() ? 2 * curr : NONE;
+    return nodes[curr].left;
+}
+
+
+template <typename T, typename Allocator>
+unsigned int AVLSet<T, Allocator>::rightOf(unsigned int curr) const
+{
+    if (isFrozen())
+        return 2 * curr + 1 < frozen.size() ? 2 * curr + 1 : NONE;
+    return nodes[curr].right;
 }
-*/
 
-#endif // AVLSET_HPP
 
+template <typename T, typename Allocator>
+const T& AVLSet<T, Allocator>::valueOf(unsigned int curr) const
+{
+    if (isFrozen())
+        return frozen[curr];
+    return nodes[curr].value;
+}
+
+
+
+#endif // AVLSET_HPP
@@ -0,0 +1,172 @@
+#include "Allocators.hpp"
+#include <algorithm>
+#include <cstdint>
+
+
+namespace
+{
+    std::size_t roundUp(std::size_t n, std::size_t alignment)
+    {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+}
+
+
+MonotonicArena::~MonotonicArena() noexcept
+{
+    for (void* block : blocks)
+        ::operator delete(block);
+}
+
+
+void* MonotonicArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(next) % alignment) % alignment;
+    if (next == nullptr || padding + bytes > remaining)
+    {
+        // Whatever is left of the current block is abandoned; a request
+        // larger than a whole block gets a block of its own size.
+        std::size_t blockSize = std::max(nextBlockSize, roundUp(bytes, alignof(std::max_align_t)));
+        void* block = ::operator new(blockSize);
+        blocks.push_back(block);
+        stats.systemAllocations++;
+        stats.systemBytes += blockSize;
+
+        next = static_cast<char*>(block);
+        remaining = blockSize;
+        padding = 0;
+        nextBlockSize = std::min(nextBlockSize * 2, MAX_BLOCK_SIZE);
+    }
+
+    void* p = next + padding;
+    next += padding + bytes;
+    remaining -= padding + bytes;
+    stats.allocations++;
+    stats.bytesAllocated += bytes;
+    return p;
+}
+
+
+void MonotonicArena::deallocate(void*, std::size_t) noexcept
+{
+    stats.deallocations++;
+}
+
+
+const AllocationCounters& MonotonicArena::counters() const noexcept
+{
+    return stats;
+}
+
+
+
+NodePool::NodePool(std::size_t objectSize, std::size_t alignment)
+    : size{roundUp(std::max(objectSize, sizeof(FreeObject)), std::max(alignment, alignof(FreeObject)))}
+{
+}
+
+
+NodePool::~NodePool() noexcept
+{
+    for (void* block : blocks)
+        ::operator delete(block);
+}
+
+
+void* NodePool::allocate()
+{
+    if (freeList == nullptr)
+    {
+        // Carve a new block into objects and put them all on the free
+        // list, in address order so that consecutive allocations are
+        // adjacent in memory.
+        char* block = static_cast<char*>(::operator new(size * OBJECTS_PER_BLOCK));
+        blocks.push_back(block);
+        stats.systemAllocations++;
+        stats.systemBytes += size * OBJECTS_PER_BLOCK;
+
+        for (std::size_t i = OBJECTS_PER_BLOCK; i > 0; i--)
+        {
+            FreeObject* object = reinterpret_cast<FreeObject*>(block + (i - 1) * size);
+            object->next = freeList;
+            freeList = object;
+        }
+    }
+
+    FreeObject* object = freeList;
+    freeList = object->next;
+    stats.allocations++;
+    stats.bytesAllocated += size;
+    return object;
+}
+
+
+void NodePool::deallocate(void* p) noexcept
+{
+    FreeObject* object = static_cast<FreeObject*>(p);
+    object->next = freeList;
+    freeList = object;
+    stats.deallocations++;
+}
+
+
+std::size_t NodePool::objectSize() const noexcept
+{
+    return size;
+}
+
+
+const AllocationCounters& NodePool::counters() const noexcept
+{
+    return stats;
+}
+
+
+
+NodePool& PoolResource::poolFor(std::size_t objectSize, std::size_t alignment)
+{
+    // Pools are found by the size they round objects up to, so types of
+    // similar size share a pool.
+    NodePool candidate{objectSize, alignment};
+    for (const std::unique_ptr<NodePool>& pool : pools)
+    {
+        if (pool->objectSize() == candidate.objectSize() && pool->objectSize() % alignment == 0)
+            return *pool;
+    }
+    pools.push_back(std::make_unique<NodePool>(objectSize, alignment));
+    return *pools.back();
+}
+
+
+void* PoolResource::allocateLarge(std::size_t bytes)
+{
+    void* p = ::operator new(bytes);
+    largeStats.allocations++;
+    largeStats.bytesAllocated += bytes;
+    largeStats.systemAllocations++;
+    largeStats.systemBytes += bytes;
+    return p;
+}
+
+
+void PoolResource::deallocateLarge(void* p) noexcept
+{
+    largeStats.deallocations++;
+    ::operator delete(p);
+}
+
+
+AllocationCounters PoolResource::counters() const noexcept
+{
+    AllocationCounters total = largeStats;
+    for (const std::unique_ptr<NodePool>& pool : pools)
+    {
+        const AllocationCounters& c = pool->counters();
+        total.allocations += c.allocations;
+        total.deallocations += c.deallocations;
+        total.bytesAllocated += c.bytesAllocated;
+        total.systemAllocations += c.systemAllocations;
+        total.systemBytes += c.systemBytes;
+    }
+    return total;
+}
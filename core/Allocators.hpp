@@ -0,0 +1,376 @@
+#ifndef ALLOCATORS_HPP
+#define ALLOCATORS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+
+
+// AllocationCounters records how a set's memory was obtained, so that the
+// effect of switching allocators can be measured rather than guessed.
+struct AllocationCounters
+{
+    // Calls to allocate() and deallocate().
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+
+    // Bytes handed out by allocate().
+    std::size_t bytesAllocated = 0;
+
+    // Calls the allocator made to the global operator new, and the bytes
+    // they asked for.
+    std::size_t systemAllocations = 0;
+    std::size_t systemBytes = 0;
+};
+
+
+
+// A MonotonicArena hands out memory by carving it off the end of large
+// blocks, never reusing any of it, and frees all of its blocks at once
+// when it is destroyed.
+class MonotonicArena
+{
+public:
+    // The size of the first block; each later block is twice as large as
+    // the one before, up to MAX_BLOCK_SIZE.
+    static constexpr std::size_t FIRST_BLOCK_SIZE = 64 * 1024;
+    static constexpr std::size_t MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+public:
+    MonotonicArena() = default;
+    ~MonotonicArena() noexcept;
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    // allocate() returns bytes bytes of memory aligned to alignment.
+    void* allocate(std::size_t bytes, std::size_t alignment);
+
+    // deallocate() records that memory is no longer used; the memory
+    // itself is only returned when the arena is destroyed.
+    void deallocate(void* p, std::size_t bytes) noexcept;
+
+    const AllocationCounters& counters() const noexcept;
+
+private:
+    std::vector<void*> blocks;
+    char* next = nullptr;
+    std::size_t remaining = 0;
+    std::size_t nextBlockSize = FIRST_BLOCK_SIZE;
+    AllocationCounters stats;
+};
+
+
+
+// A NodePool hands out memory in objects of one fixed size, taken from
+// large blocks.  Deallocated objects go on a free list and are reused by
+// later allocations.  All blocks are freed at once when the pool is
+// destroyed.
+class NodePool
+{
+public:
+    // How many objects each block holds.
+    static constexpr std::size_t OBJECTS_PER_BLOCK = 1024;
+
+public:
+    // Initializes a pool of objects of the given size and alignment.
+    NodePool(std::size_t objectSize, std::size_t alignment);
+    ~NodePool() noexcept;
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // allocate() returns memory for one object.
+    void* allocate();
+
+    // deallocate() puts an object allocated by this pool back on the free
+    // list.
+    void deallocate(void* p) noexcept;
+
+    std::size_t objectSize() const noexcept;
+    const AllocationCounters& counters() const noexcept;
+
+private:
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+
+    std::size_t size;
+    std::vector<void*> blocks;
+    FreeObject* freeList = nullptr;
+    AllocationCounters stats;
+};
+
+
+
+// A PoolResource keeps one NodePool for each object size that is asked
+// of it, so that allocators rebound to different types can share it.
+// Allocations of more than one object go straight to the global operator
+// new.
+class PoolResource
+{
+public:
+    PoolResource() = default;
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    // poolFor() returns the pool for objects of the given size and
+    // alignment, creating it if there is none yet.
+    NodePool& poolFor(std::size_t objectSize, std::size_t alignment);
+
+    void* allocateLarge(std::size_t bytes);
+    void deallocateLarge(void* p) noexcept;
+
+    // counters() adds together the counters of every pool and those of
+    // the larger allocations.
+    AllocationCounters counters() const noexcept;
+
+private:
+    std::vector<std::unique_ptr<NodePool>> pools;
+    AllocationCounters largeStats;
+};
+
+
+// ArenaAllocator is a standard allocator that takes its memory from a
+// MonotonicArena.  A default-constructed ArenaAllocator creates a new
+// arena, which it shares with all of its copies, so a set built with one
+// has an arena to itself.  Because deallocating from an arena does
+// nothing, the sets skip visiting their elements on destruction when the
+// elements have no destructor to run.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    static constexpr bool RELEASES_IN_BULK = true;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    // The memory belongs to the set rather than to any one array in it,
+    // so the allocator travels with the arrays when they are moved,
+    // swapped or assigned.
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+public:
+    ArenaAllocator()
+        : arena{std::make_shared<MonotonicArena>()}
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& a) noexcept
+        : arena{a.arena}
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        arena->deallocate(p, n * sizeof(T));
+    }
+
+    const AllocationCounters& counters() const noexcept
+    {
+        return arena->counters();
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& a) const noexcept
+    {
+        return arena == a.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& a) const noexcept
+    {
+        return arena != a.arena;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    std::shared_ptr<MonotonicArena> arena;
+};
+
+
+
+// PoolAllocator is a standard allocator that serves single objects from a
+// NodePool, so that freed nodes are reused, and anything larger from the
+// global operator new.  A default-constructed PoolAllocator creates a new
+// PoolResource, which it shares with all of its copies, including those
+// rebound to other types.
+template <typename T>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef PoolAllocator<U> other;
+    };
+
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+public:
+    PoolAllocator()
+        : resource{std::make_shared<PoolResource>()},
+          pool{&resource->poolFor(sizeof(T), alignof(T))}
+    {
+    }
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& a)
+        : resource{a.resource},
+          pool{&resource->poolFor(sizeof(T), alignof(T))}
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n == 1)
+            return static_cast<T*>(pool->allocate());
+        return static_cast<T*>(resource->allocateLarge(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if (n == 1)
+            pool->deallocate(p);
+        else
+            resource->deallocateLarge(p);
+    }
+
+    AllocationCounters counters() const noexcept
+    {
+        return resource->counters();
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& a) const noexcept
+    {
+        return resource == a.resource;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& a) const noexcept
+    {
+        return resource != a.resource;
+    }
+
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    std::shared_ptr<PoolResource> resource;
+    NodePool* pool;
+};
+
+
+
+// CountingAllocator is std::allocator with AllocationCounters attached,
+// shared by all of its copies, as a baseline to compare the others with.
+template <typename T>
+class CountingAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef CountingAllocator<U> other;
+    };
+
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+public:
+    CountingAllocator()
+        : stats{std::make_shared<AllocationCounters>()}
+    {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& a) noexcept
+        : stats{a.stats}
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        stats->allocations++;
+        stats->bytesAllocated += n * sizeof(T);
+        stats->systemAllocations++;
+        stats->systemBytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        stats->deallocations++;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    const AllocationCounters& counters() const noexcept
+    {
+        return *stats;
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& a) const noexcept
+    {
+        return stats == a.stats;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& a) const noexcept
+    {
+        return stats != a.stats;
+    }
+
+private:
+    template <typename U>
+    friend class CountingAllocator;
+
+    std::shared_ptr<AllocationCounters> stats;
+};
+
+
+
+// releasesInBulk<Allocator>::value is true for allocators whose
+// deallocate() does nothing, so that a set can skip deallocating its
+// nodes one by one when they have no destructor to run either.
+template <typename Allocator, typename = void>
+struct releasesInBulk : std::false_type
+{
+};
+
+template <typename Allocator>
+struct releasesInBulk<Allocator, std::enable_if_t<Allocator::RELEASES_IN_BULK>> : std::true_type
+{
+};
+
+
+
+#endif // ALLOCATORS_HPP
@@ -0,0 +1,912 @@
+#ifndef BASICWORDCHECKER_HPP
+#define BASICWORDCHECKER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "BloomFilter.hpp"
+#include "DeletionIndex.hpp"
+#include "EditDistanceIndex.hpp"
+#include "HashPolicies.hpp"
+#include "Set.hpp"
+#include "Stats.hpp"
+#include "SuggestionCache.hpp"
+#include "SuggestionRange.hpp"
+#include "TrieSet.hpp"
+#include "WordFrequencies.hpp"
+#include "WorkStealingPool.hpp"
+
+
+
+// A CheckResult is what checkDocument() found out about one token.
+struct CheckResult
+{
+    bool exists = false;
+    std::vector<std::string> suggestions;
+};
+
+
+
+namespace BasicWordCheckerDetail
+{
+    // hasContainsMany<SetType>::value is true for sets with a batched
+    // containsMany() that accepts std::string_view keys.
+    template <typename SetType, typename = void>
+    struct hasContainsMany : std::false_type
+    {
+    };
+
+    template <typename SetType>
+    struct hasContainsMany<SetType, std::void_t<decltype(
+        std::declval<const SetType&>().containsMany(
+            std::declval<const std::vector<std::string_view>&>(),
+            std::declval<std::vector<bool>&>()))>>
+        : std::true_type
+    {
+    };
+
+
+    // hashesByPolynomial<SetType>::value is true for sets whose hash
+    // policy is PolynomialHash.
+    template <typename SetType, typename = void>
+    struct hashesByPolynomial : std::false_type
+    {
+    };
+
+    template <typename SetType>
+    struct hashesByPolynomial<SetType, std::void_t<typename SetType::HashPolicyType>>
+        : std::is_same<typename SetType::HashPolicyType, PolynomialHash>
+    {
+    };
+
+
+
+    // hasVersion<SetType>::value is true for sets with a version() that
+    // changes whenever their elements might have (see SetVersion.hpp).
+    template <typename SetType, typename = void>
+    struct hasVersion : std::false_type
+    {
+    };
+
+    template <typename SetType>
+    struct hasVersion<SetType, std::void_t<decltype(std::declval<const SetType&>().version())>>
+        : std::true_type
+    {
+    };
+}
+
+
+
+// A BasicWordChecker checks words against a set whose concrete type it
+// knows at compile time, so that every lookup of a candidate spelling is
+// a direct call into that set, one the compiler can inline into the loops
+// that generate the candidates.  It works with any set of strings; a
+// SetType of Set<std::string> checks through the virtual interface
+// instead.  WordChecker wraps it for callers that only have a
+// Set<std::string>.
+//
+// When the set hashes with PolynomialHash, the hash of every candidate
+// is derived in constant time from hashes of the word's prefixes and
+// suffixes, computed once per word, and the set is asked through
+// containsManyHashed() so that no candidate is hashed from scratch.
+template <typename SetType>
+class BasicWordChecker
+{
+public:
+    typedef ::CheckResult CheckResult;
+
+    // The letters that are inserted and used as replacements when
+    // generating candidate spellings.
+    static constexpr std::string_view ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+public:
+    BasicWordChecker(const SetType& words);
+
+    // wordExists() returns true if the given word is spelled correctly,
+    // false otherwise.
+    bool wordExists(const std::string& word) const;
+
+
+    // findSuggestions() returns a vector containing suggested alternative
+    // spellings for the given word.  When the words are in a TrieSet, the
+    // swaps, insertions, deletions and replacements are all found by one
+    // search of the trie rather than by probing for every candidate.
+    std::vector<std::string> findSuggestions(const std::string& word) const;
+
+
+    // findTopSuggestions() returns at most k of the suggestions that
+    // findSuggestions() would, best first and each only once, leaving out
+    // the word itself.  They are ranked by the cost of the edit that
+    // makes them from the word, then by their frequencies if a table was
+    // given to useWordFrequencies(), then alphabetically.  A swap of two
+    // letters, or the removal of a stray one, costs 1; a missing or wrong
+    // letter costs 2; splitting the word in two costs 3.
+    //
+    // Candidates are generated a kind of edit at a time, cheapest first,
+    // and generation stops once k suggestions have been found that nothing
+    // generated later could outrank, so that for most misspellings only
+    // the few cheap candidates are ever looked up.
+    std::vector<std::string> findTopSuggestions(const std::string& word, std::size_t k) const;
+
+
+    // findNearSuggestions() returns the words within maxDistance edits of
+    // the given word, leaving out the word itself, nearest first, then by
+    // their frequencies if a table was given to useWordFrequencies(), then
+    // alphabetically.  They are found by scanning the index given to
+    // useEditDistanceIndex(); a scan that runs out of its budget returns
+    // what it found by then, which favors words of about the word's own
+    // length.  Without an index, or for a word longer than the index's
+    // MAX_WORD_LENGTH, only the suggestions one edit away can be found, and
+    // all of findTopSuggestions()'s are returned.
+    std::vector<std::string> findNearSuggestions(const std::string& word, unsigned int maxDistance = 2) const;
+
+
+    // suggestions() returns a range that yields the same suggestions as
+    // findSuggestions(), in the same order, finding them one kind of edit
+    // at a time as the range is iterated.  The range must not outlive the
+    // checker.  A cached word is yielded from the cache; otherwise nothing
+    // is cached, since iteration may be abandoned part way.
+    SuggestionRange suggestions(const std::string& word) const;
+
+
+    // useDeletionIndex() makes findSuggestions() look up near words in the
+    // given index, which must hold the same words as the set, instead of
+    // generating and probing candidates.  The suggestions are the same
+    // either way; the index trades memory for lower latency.  Passing
+    // nullptr goes back to generating candidates.
+    void useDeletionIndex(const DeletionIndex* index) noexcept;
+
+
+    // useEditDistanceIndex() gives findNearSuggestions() an index to scan,
+    // which must hold the same words as the set, and the time it may take
+    // over each word; a budget of zero means no limit.  Passing nullptr
+    // stops using an index.
+    void useEditDistanceIndex(
+        const EditDistanceIndex* index,
+        std::chrono::nanoseconds budget = EditDistanceIndex::DEFAULT_BUDGET) noexcept;
+
+
+    // useBloomFilter() makes the checker test every candidate spelling
+    // against the given filter, which must hold every word in the set, and
+    // only look up in the set those that pass.  Passing nullptr goes back
+    // to looking up every candidate.
+    void useBloomFilter(const BloomFilter* filter) noexcept;
+
+
+    // useSuggestionCache() makes findSuggestions() look for the word in the
+    // given cache first, and add what it finds there when the word is not
+    // in it.  The cache may be shared by many checkers, on many threads
+    // and on different sets.  Passing nullptr stops using a cache.
+    void useSuggestionCache(SuggestionCache* cache) noexcept;
+
+
+    // useWordFrequencies() makes findTopSuggestions() rank suggestions of
+    // equal cost by their frequencies in the given table.  Passing nullptr
+    // ranks them alphabetically.
+    void useWordFrequencies(const WordFrequencies* frequencies) noexcept;
+
+
+    // checkDocument() checks every token using the given pool's threads,
+    // returning one CheckResult per token in the same order as the tokens.
+    // Suggestions are only found for tokens that are not words.
+    std::vector<CheckResult> checkDocument(
+        const std::vector<std::string>& tokens, WorkStealingPool& pool) const;
+
+
+private:
+    // Whether candidates are hashed incrementally, as described above.
+    static constexpr bool ROLLING_HASHES = BasicWordCheckerDetail::hashesByPolynomial<SetType>::value;
+
+    // A CandidateBatch holds candidate spellings that are looked up in the
+    // set together.  Each candidate is a view into text, and found says
+    // which of them are words once the batch has been looked up.
+    //
+    // With rolling hashes, hashes holds each candidate's hash, and prefix,
+    // suffix and powers hold the polynomials of the word's first i
+    // letters, of its letters from i on, and the powers of the base.
+    struct CandidateBatch
+    {
+        std::string text;
+        std::vector<std::string_view> candidates;
+        std::vector<bool> found;
+        std::vector<std::uint64_t> hashes;
+        std::vector<std::uint64_t> prefix;
+        std::vector<std::uint64_t> suffix;
+        std::vector<std::uint64_t> powers;
+
+        // The candidates that passed the Bloom filter, their indexes among
+        // all of the candidates, their hashes and which of them are words.
+        std::vector<std::string_view> passed;
+        std::vector<std::size_t> passedIndexes;
+        std::vector<std::uint64_t> passedHashes;
+        std::vector<bool> passedFound;
+    };
+
+    // The costs of edits, as findTopSuggestions() describes them.
+    static constexpr unsigned int SWAP_COST = 1;
+    static constexpr unsigned int DELETE_COST = 1;
+    static constexpr unsigned int INSERT_COST = 2;
+    static constexpr unsigned int REPLACE_COST = 2;
+    static constexpr unsigned int SPLIT_COST = 3;
+
+    struct RankedSuggestion
+    {
+        std::string word;
+        unsigned int cost;
+        std::uint64_t frequency;
+    };
+
+    const SetType& words;
+    const DeletionIndex* deletionIndex;
+    const EditDistanceIndex* editIndex;
+    std::chrono::nanoseconds editBudget;
+    const BloomFilter* filter;
+    SuggestionCache* cache;
+    const WordFrequencies* frequencies;
+
+    SuggestionCache::Stamp stamp() const noexcept;
+    std::vector<std::string> generateSuggestions(const std::string& word) const;
+    bool suggestionsInStage(const std::string& word, unsigned int stage, std::vector<std::string>& suggest) const;
+    void rank(const std::string& word, std::vector<std::string>& found, std::vector<RankedSuggestion>& ranked) const;
+    static unsigned int editCost(const std::string& word, const std::string& suggestion) noexcept;
+    void swapAdjacent(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void addChars(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void delEach(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void repChar(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void splitWord(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void lookup(CandidateBatch& batch, std::vector<std::string>& suggest) const;
+    void lookupAll(CandidateBatch& batch) const;
+    void lookupIn(
+        const std::vector<std::string_view>& keys, const std::vector<std::uint64_t>& hashes,
+        std::vector<bool>& found) const;
+    static CandidateBatch& threadBatch();
+    static char* makeRoom(CandidateBatch& batch, std::size_t count, std::size_t length);
+    static void prepareHashes(const std::string& word, CandidateBatch& batch);
+    static std::uint64_t digit(char c) noexcept;
+};
+
+
+
+template <typename SetType>
+BasicWordChecker<SetType>::BasicWordChecker(const SetType& words)
+    : words{words}, deletionIndex{nullptr}, editIndex{nullptr}, editBudget{EditDistanceIndex::DEFAULT_BUDGET},
+      filter{nullptr}, cache{nullptr}, frequencies{nullptr}
+{
+}
+
+
+template <typename SetType>
+SuggestionCache::Stamp BasicWordChecker<SetType>::stamp() const noexcept
+{
+    // A set without a version is stamped with its size, as
+    // SuggestionCache describes.
+    if constexpr (BasicWordCheckerDetail::hasVersion<SetType>::value)
+        return SuggestionCache::Stamp{&words, words.version()};
+    else
+        return SuggestionCache::Stamp{&words, words.size()};
+}
+
+
+template <typename SetType>
+bool BasicWordChecker<SetType>::wordExists(const std::string& word) const
+{
+    STATS_TIME("wordExists.latency_ns");
+
+    // Naming the concrete type's contains() binds the call statically,
+    // rather than leaving it to the compiler to prove which override the
+    // virtual call would reach.
+    if constexpr (std::is_same<SetType, Set<std::string>>::value)
+        return words.contains(word);
+    else
+        return words.SetType::contains(word);
+}
+
+
+template <typename SetType>
+std::vector<std::string> BasicWordChecker<SetType>::findSuggestions(const std::string& word) const
+{
+    STATS_TIME("findSuggestions.latency_ns");
+
+    if (cache == nullptr)
+        return generateSuggestions(word);
+
+    // The generation is read before the suggestions are generated, so
+    // that they are not cached if the dictionary is replaced meanwhile.
+    SuggestionCache::Stamp stamp = this->stamp();
+    unsigned long long generation = cache->generation();
+    std::vector<std::string> suggest;
+    if (!cache->find(word, stamp, suggest))
+    {
+        suggest = generateSuggestions(word);
+        cache->insert(word, stamp, generation, suggest);
+    }
+    return suggest;
+}
+
+
+template <typename SetType>
+std::vector<std::string> BasicWordChecker<SetType>::generateSuggestions(const std::string& word) const
+{
+    CandidateBatch& batch = threadBatch();
+    std::vector<std::string> suggest;
+
+    if constexpr (ROLLING_HASHES)
+        prepareHashes(word, batch);
+
+    if (deletionIndex != nullptr)
+        deletionIndex->nearWords(word, ALPHABET, suggest);
+    else if constexpr (std::is_same<SetType, TrieSet>::value)
+        words.nearWords(word, ALPHABET, suggest);
+    else
+    {
+        swapAdjacent(word, batch, suggest);
+        addChars(word, batch, suggest);
+        delEach(word, batch, suggest);
+        repChar(word, batch, suggest);
+    }
+    splitWord(word, batch, suggest);
+    return suggest;
+}
+
+
+template <typename SetType>
+std::vector<std::string> BasicWordChecker<SetType>::findTopSuggestions(const std::string& word, std::size_t k) const
+{
+    STATS_TIME("findTopSuggestions.latency_ns");
+
+    std::vector<RankedSuggestion> ranked;
+    std::vector<std::string> found;
+
+    // enough() is true once k suggestions cost less than anything that an
+    // edit costing nextCost could add, so that none of them can be pushed
+    // out of the top k.
+    auto enough = [&](unsigned int nextCost)
+    {
+        return static_cast<std::size_t>(std::count_if(ranked.begin(), ranked.end(),
+            [nextCost](const RankedSuggestion& r) { return r.cost < nextCost; })) >= k;
+    };
+
+    if (k == 0)
+        return {};
+
+    // Cached suggestions are complete, so they only need ranking.
+    if (cache != nullptr && cache->find(word, stamp(), found))
+        rank(word, found, ranked);
+    else
+    {
+        CandidateBatch& batch = threadBatch();
+        if constexpr (ROLLING_HASHES)
+            prepareHashes(word, batch);
+
+        if (deletionIndex != nullptr)
+            deletionIndex->nearWords(word, ALPHABET, found);
+        else if constexpr (std::is_same<SetType, TrieSet>::value)
+            words.nearWords(word, ALPHABET, found);
+        else
+        {
+            swapAdjacent(word, batch, found);
+            delEach(word, batch, found);
+            rank(word, found, ranked);
+
+            if (!enough(INSERT_COST))
+            {
+                addChars(word, batch, found);
+                repChar(word, batch, found);
+            }
+        }
+        rank(word, found, ranked);
+
+        if (!enough(SPLIT_COST))
+        {
+            splitWord(word, batch, found);
+            rank(word, found, ranked);
+        }
+    }
+
+    std::size_t count = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+        [](const RankedSuggestion& a, const RankedSuggestion& b)
+        {
+            if (a.cost != b.cost)
+                return a.cost < b.cost;
+            if (a.frequency != b.frequency)
+                return a.frequency > b.frequency;
+            return a.word < b.word;
+        });
+
+    std::vector<std::string> top;
+    top.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+        top.push_back(std::move(ranked[i].word));
+    return top;
+}
+
+
+template <typename SetType>
+std::vector<std::string> BasicWordChecker<SetType>::findNearSuggestions(
+    const std::string& word, unsigned int maxDistance) const
+{
+    STATS_TIME("findNearSuggestions.latency_ns");
+
+    // A word too long for the index to scan gets the suggestions one edit
+    // away, as it would without an index, rather than none at all.
+    if (editIndex == nullptr || word.size() > EditDistanceIndex::MAX_WORD_LENGTH)
+        return findTopSuggestions(word, std::numeric_limits<std::size_t>::max());
+
+    std::vector<EditDistanceIndex::NearWord> near;
+    if (!editIndex->nearWords(word, maxDistance, editBudget, near))
+        STATS_COUNT("findNearSuggestions.incomplete");
+
+    // The index returns the words alphabetically within each distance, so
+    // a stable sort by frequency leaves ties in alphabetical order.
+    near.erase(std::remove_if(near.begin(), near.end(),
+        [&word](const EditDistanceIndex::NearWord& n) { return n.word == word; }), near.end());
+
+    if (frequencies != nullptr)
+    {
+        std::vector<std::pair<EditDistanceIndex::NearWord, std::uint64_t>> weighed;
+        weighed.reserve(near.size());
+        for (EditDistanceIndex::NearWord& n : near)
+        {
+            std::uint64_t frequency = frequencies->frequency(n.word);
+            weighed.emplace_back(std::move(n), frequency);
+        }
+
+        std::stable_sort(weighed.begin(), weighed.end(),
+            [](const auto& a, const auto& b)
+            {
+                if (a.first.distance != b.first.distance)
+                    return a.first.distance < b.first.distance;
+                return a.second > b.second;
+            });
+
+        for (std::size_t i = 0; i < near.size(); i++)
+            near[i] = std::move(weighed[i].first);
+    }
+
+    std::vector<std::string> suggest;
+    suggest.reserve(near.size());
+    for (EditDistanceIndex::NearWord& n : near)
+        suggest.push_back(std::move(n.word));
+    return suggest;
+}
+
+
+template <typename SetType>
+SuggestionRange BasicWordChecker<SetType>::suggestions(const std::string& word) const
+{
+    return SuggestionRange{word, [this](const std::string& word, unsigned int stage, std::vector<std::string>& found)
+    {
+        return suggestionsInStage(word, stage, found);
+    }};
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::useDeletionIndex(const DeletionIndex* index) noexcept
+{
+    deletionIndex = index;
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::useEditDistanceIndex(
+    const EditDistanceIndex* index, std::chrono::nanoseconds budget) noexcept
+{
+    editIndex = index;
+    editBudget = budget;
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::useBloomFilter(const BloomFilter* filter) noexcept
+{
+    this->filter = filter;
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::useSuggestionCache(SuggestionCache* cache) noexcept
+{
+    this->cache = cache;
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::useWordFrequencies(const WordFrequencies* frequencies) noexcept
+{
+    this->frequencies = frequencies;
+}
+
+
+template <typename SetType>
+std::vector<CheckResult> BasicWordChecker<SetType>::checkDocument(
+    const std::vector<std::string>& tokens, WorkStealingPool& pool) const
+{
+    // Each token's result has its own slot, so the threads never write to
+    // the same place and the results come out in token order.
+    std::vector<CheckResult> results(tokens.size());
+    pool.parallelFor(tokens.size(), [&](std::size_t i)
+    {
+        results[i].exists = wordExists(tokens[i]);
+        if (!results[i].exists)
+            results[i].suggestions = findSuggestions(tokens[i]);
+    });
+    return results;
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::swapAdjacent(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    if (word.size() < 2)
+        return;
+
+    char* next = makeRoom(batch, word.size() - 1, word.size());
+    for (std::size_t i = 0; i + 1 < word.size(); i++)
+    {
+        word.copy(next, word.size());
+        std::swap(next[i], next[i+1]);
+        batch.candidates.emplace_back(next, word.size());
+        next += word.size();
+
+        if constexpr (ROLLING_HASHES)
+        {
+            std::size_t n = word.size();
+            batch.hashes.push_back(PolynomialHash::finalize(
+                batch.prefix[i] * batch.powers[n-i] + digit(word[i+1]) * batch.powers[n-1-i]
+                + digit(word[i]) * batch.powers[n-2-i] + batch.suffix[i+2], n));
+        }
+    }
+    STATS_RECORD("findSuggestions.swapAdjacent.probes", batch.candidates.size());
+    lookup(batch, suggest);
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::addChars(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    std::size_t length = word.size() + 1;
+    char* next = makeRoom(batch, length * ALPHABET.size(), length);
+    for (std::size_t i = 0; i <= word.size(); i++)
+    {
+        for (char letter : ALPHABET)
+        {
+            word.copy(next, i);
+            next[i] = letter;
+            word.copy(next + i + 1, word.size() - i, i);
+            batch.candidates.emplace_back(next, length);
+            next += length;
+
+            if constexpr (ROLLING_HASHES)
+            {
+                std::size_t n = word.size();
+                batch.hashes.push_back(PolynomialHash::finalize(
+                    batch.prefix[i] * batch.powers[n+1-i] + digit(letter) * batch.powers[n-i]
+                    + batch.suffix[i], length));
+            }
+        }
+    }
+    STATS_RECORD("findSuggestions.addChars.probes", batch.candidates.size());
+    lookup(batch, suggest);
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::delEach(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    if (word.empty())
+        return;
+
+    std::size_t length = word.size() - 1;
+    char* next = makeRoom(batch, word.size(), length);
+    for (std::size_t i = 0; i < word.size(); i++)
+    {
+        if (i + 1 < word.size() && word[i] == word[i+1])
+            continue;
+        word.copy(next, i);
+        word.copy(next + i, length - i, i + 1);
+        batch.candidates.emplace_back(next, length);
+        next += length;
+
+        if constexpr (ROLLING_HASHES)
+        {
+            batch.hashes.push_back(PolynomialHash::finalize(
+                batch.prefix[i] * batch.powers[length-i] + batch.suffix[i+1], length));
+        }
+    }
+    STATS_RECORD("findSuggestions.delEach.probes", batch.candidates.size());
+    lookup(batch, suggest);
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::repChar(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    char* next = makeRoom(batch, word.size() * ALPHABET.size(), word.size());
+    for (std::size_t i = 0; i < word.size(); i++)
+    {
+        for (char letter : ALPHABET)
+        {
+            word.copy(next, word.size());
+            next[i] = letter;
+            batch.candidates.emplace_back(next, word.size());
+            next += word.size();
+
+            if constexpr (ROLLING_HASHES)
+            {
+                std::size_t n = word.size();
+                batch.hashes.push_back(PolynomialHash::finalize(
+                    batch.prefix[i] * batch.powers[n-i] + digit(letter) * batch.powers[n-1-i]
+                    + batch.suffix[i+1], n));
+            }
+        }
+    }
+    STATS_RECORD("findSuggestions.repChar.probes", batch.candidates.size());
+    lookup(batch, suggest);
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::splitWord(const std::string& word, CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    // Both halves of every split are views into the word itself, so
+    // nothing is copied.  All of the first halves and then all of the
+    // second halves are looked up as one batch.
+    if (word.size() < 2)
+        return;
+
+    std::string_view whole{word};
+    std::size_t splits = word.size() - 1;
+    batch.candidates.clear();
+    batch.hashes.clear();
+    for (std::size_t i = 1; i < word.size(); i++)
+        batch.candidates.push_back(whole.substr(0, i));
+    for (std::size_t i = 1; i < word.size(); i++)
+        batch.candidates.push_back(whole.substr(i));
+
+    if constexpr (ROLLING_HASHES)
+    {
+        for (std::size_t i = 1; i < word.size(); i++)
+            batch.hashes.push_back(PolynomialHash::finalize(batch.prefix[i], i));
+        for (std::size_t i = 1; i < word.size(); i++)
+            batch.hashes.push_back(PolynomialHash::finalize(batch.suffix[i], word.size() - i));
+    }
+    STATS_RECORD("findSuggestions.splitWord.probes", batch.candidates.size());
+    lookupAll(batch);
+
+    for (std::size_t i = 1; i < word.size(); i++)
+    {
+        if (batch.found[i-1] && batch.found[splits+i-1])
+        {
+            std::string s = word;
+            s.insert(i, " ");
+            suggest.push_back(s);
+        }
+    }
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::lookup(CandidateBatch& batch, std::vector<std::string>& suggest) const
+{
+    lookupAll(batch);
+    for (std::size_t i = 0; i < batch.candidates.size(); i++)
+    {
+        if (batch.found[i])
+            suggest.emplace_back(batch.candidates[i]);
+    }
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::lookupAll(CandidateBatch& batch) const
+{
+    if (filter == nullptr)
+    {
+        lookupIn(batch.candidates, batch.hashes, batch.found);
+        return;
+    }
+
+    // Most candidates are not words, and the filter turns nearly all of
+    // them away, so only the few that pass are gathered up and looked up
+    // in the set.
+    filter->mayContainMany(batch.candidates, batch.found);
+    batch.passed.clear();
+    batch.passedIndexes.clear();
+    batch.passedHashes.clear();
+    for (std::size_t i = 0; i < batch.candidates.size(); i++)
+    {
+        if (batch.found[i])
+        {
+            batch.passed.push_back(batch.candidates[i]);
+            batch.passedIndexes.push_back(i);
+            if constexpr (ROLLING_HASHES)
+                batch.passedHashes.push_back(batch.hashes[i]);
+        }
+    }
+
+    STATS_RECORD("findSuggestions.bloomFilter.passed", batch.passed.size());
+    lookupIn(batch.passed, batch.passedHashes, batch.passedFound);
+    for (std::size_t j = 0; j < batch.passed.size(); j++)
+        batch.found[batch.passedIndexes[j]] = batch.passedFound[j];
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::lookupIn(
+    const std::vector<std::string_view>& keys, const std::vector<std::uint64_t>& hashes,
+    std::vector<bool>& found) const
+{
+    if constexpr (ROLLING_HASHES)
+        words.containsManyHashed(keys, hashes, found);
+    else if constexpr (BasicWordCheckerDetail::hasContainsMany<SetType>::value)
+        words.containsMany(keys, found);
+    else
+    {
+        // Sets without a batched lookup are asked about one key at a time,
+        // through a per-thread buffer so that no key is allocated.
+        thread_local std::string buffer;
+        found.assign(keys.size(), false);
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            buffer.assign(keys[i]);
+            found[i] = words.contains(buffer);
+        }
+    }
+}
+
+
+template <typename SetType>
+bool BasicWordChecker<SetType>::suggestionsInStage(
+    const std::string& word, unsigned int stage, std::vector<std::string>& suggest) const
+{
+    // The stages are the steps of generateSuggestions(), in its order.
+    // Other calls on this thread may use the batch between stages, so the
+    // hashes are prepared again for each one.
+    if (stage == 0 && cache != nullptr && cache->find(word, stamp(), suggest))
+        return false;
+
+    CandidateBatch& batch = threadBatch();
+    if constexpr (ROLLING_HASHES)
+        prepareHashes(word, batch);
+
+    if (deletionIndex != nullptr || std::is_same<SetType, TrieSet>::value)
+    {
+        if (stage > 0)
+        {
+            splitWord(word, batch, suggest);
+            return false;
+        }
+
+        if (deletionIndex != nullptr)
+            deletionIndex->nearWords(word, ALPHABET, suggest);
+        else if constexpr (std::is_same<SetType, TrieSet>::value)
+            words.nearWords(word, ALPHABET, suggest);
+        return true;
+    }
+
+    switch (stage)
+    {
+    case 0:
+        swapAdjacent(word, batch, suggest);
+        return true;
+    case 1:
+        addChars(word, batch, suggest);
+        return true;
+    case 2:
+        delEach(word, batch, suggest);
+        return true;
+    case 3:
+        repChar(word, batch, suggest);
+        return true;
+    default:
+        splitWord(word, batch, suggest);
+        return false;
+    }
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::rank(
+    const std::string& word, std::vector<std::string>& found, std::vector<RankedSuggestion>& ranked) const
+{
+    // Different edits can make the same word (deleting either of a
+    // doubled letter, or replacing a letter with itself), and swapping
+    // two equal letters makes the word itself, so both are dropped here.
+    // There are rarely more than a few dozen suggestions, so a linear
+    // search for duplicates is cheaper than hashing them.
+    for (std::string& s : found)
+    {
+        if (s == word || std::any_of(ranked.begin(), ranked.end(),
+                [&s](const RankedSuggestion& r) { return r.word == s; }))
+        {
+            continue;
+        }
+
+        unsigned int cost = editCost(word, s);
+        std::uint64_t frequency = frequencies != nullptr ? frequencies->frequency(s) : 0;
+        ranked.push_back(RankedSuggestion{std::move(s), cost, frequency});
+    }
+    found.clear();
+}
+
+
+template <typename SetType>
+unsigned int BasicWordChecker<SetType>::editCost(const std::string& word, const std::string& suggestion) noexcept
+{
+    // The kind of edit is told from the suggestion itself, since those
+    // found by a DeletionIndex or a TrieSet come without it.
+    if (suggestion.find(' ') != std::string::npos)
+        return SPLIT_COST;
+    if (suggestion.size() + 1 == word.size())
+        return DELETE_COST;
+    if (suggestion.size() == word.size() + 1)
+        return INSERT_COST;
+
+    std::size_t i = 0;
+    while (i < word.size() && word[i] == suggestion[i])
+        i++;
+    bool swapped = i + 1 < word.size()
+        && word[i] == suggestion[i+1] && word[i+1] == suggestion[i]
+        && word.compare(i + 2, std::string::npos, suggestion, i + 2, std::string::npos) == 0;
+    return swapped ? SWAP_COST : REPLACE_COST;
+}
+
+
+template <typename SetType>
+typename BasicWordChecker<SetType>::CandidateBatch& BasicWordChecker<SetType>::threadBatch()
+{
+    // One batch per thread serves every way of finding suggestions, so
+    // that its buffers keep their capacity from one call to the next.
+    thread_local CandidateBatch batch;
+    return batch;
+}
+
+
+template <typename SetType>
+char* BasicWordChecker<SetType>::makeRoom(CandidateBatch& batch, std::size_t count, std::size_t length)
+{
+    // Candidates are laid out back to back in one buffer, which is sized
+    // for all of them before any view into it is taken.
+    batch.text.resize(count * length);
+    batch.candidates.clear();
+    batch.hashes.clear();
+    return &batch.text[0];
+}
+
+
+template <typename SetType>
+void BasicWordChecker<SetType>::prepareHashes(const std::string& word, CandidateBatch& batch)
+{
+    // The polynomial of a concatenation is that of its first part times
+    // B to the length of its second part, plus that of its second part,
+    // so every candidate's polynomial is a sum of a few of these terms.
+    std::size_t n = word.size();
+    batch.prefix.assign(n + 1, 0);
+    batch.suffix.assign(n + 1, 0);
+    batch.powers.assign(n + 2, 1);
+    for (std::size_t i = 1; i < n + 2; i++)
+        batch.powers[i] = batch.powers[i-1] * PolynomialHash::BASE;
+    for (std::size_t i = 0; i < n; i++)
+        batch.prefix[i+1] = batch.prefix[i] * PolynomialHash::BASE + digit(word[i]);
+    for (std::size_t i = n; i > 0; i--)
+        batch.suffix[i-1] = digit(word[i-1]) * batch.powers[n-i] + batch.suffix[i];
+}
+
+
+template <typename SetType>
+std::uint64_t BasicWordChecker<SetType>::digit(char c) noexcept
+{
+    return static_cast<unsigned char>(c);
+}
+
+
+
+#endif // BASICWORDCHECKER_HPP
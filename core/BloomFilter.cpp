@@ -0,0 +1,98 @@
+#include "BloomFilter.hpp"
+#include <cmath>
+
+
+namespace
+{
+    // The positions of a string's bits within its block come from a
+    // second hash, nine bits at a time, rotating it between positions.
+    std::uint64_t positionHash(std::uint64_t hash) noexcept
+    {
+        return hash * 0x9e3779b97f4a7c15ull;
+    }
+
+    int popcount(std::uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        int count = 0;
+        for (; x != 0; x &= x - 1)
+            count++;
+        return count;
+#endif
+    }
+}
+
+
+BloomFilter::BloomFilter(unsigned int expectedCount, unsigned int bitsPerString)
+    : blocks(std::max<std::size_t>(1, (std::size_t{expectedCount} * bitsPerString + 511) / 512))
+{
+}
+
+
+void BloomFilter::add(std::string_view s)
+{
+    std::uint64_t hash = StringHash{}(s);
+    Block& block = blocks[blockOf(hash)];
+
+    std::uint64_t positions = positionHash(hash);
+    for (unsigned int i = 0; i < BITS_PER_STRING; i++)
+    {
+        unsigned int bit = positions & 511;
+        block.words[bit >> 6] |= std::uint64_t{1} << (bit & 63);
+        positions = (positions >> 9) | (positions << 55);
+    }
+}
+
+
+bool BloomFilter::mayContain(std::string_view s) const noexcept
+{
+    std::uint64_t hash = StringHash{}(s);
+    return test(blocks[blockOf(hash)], hash);
+}
+
+
+double BloomFilter::expectedFalsePositiveRate() const noexcept
+{
+    // A string never added gets through when all of its bits happen to be
+    // set in the block it lands in, so the rate is the average, over the
+    // blocks, of the block's fill raised to the number of bits tested.
+    double total = 0.0;
+    for (const Block& block : blocks)
+    {
+        int set = 0;
+        for (std::uint64_t word : block.words)
+            set += popcount(word);
+        total += std::pow(set / 512.0, BITS_PER_STRING);
+    }
+    return total / blocks.size();
+}
+
+
+std::size_t BloomFilter::memoryUsage() const noexcept
+{
+    return sizeof(*this) + blocks.capacity() * sizeof(Block);
+}
+
+
+std::size_t BloomFilter::blockOf(std::uint64_t hash) const noexcept
+{
+    // Multiplying the upper half of the hash by the number of blocks maps
+    // it onto them evenly without a division.
+    return ((hash >> 32) * blocks.size()) >> 32;
+}
+
+
+bool BloomFilter::test(const Block& block, std::uint64_t hash) const noexcept
+{
+    std::uint64_t positions = positionHash(hash);
+    bool all = true;
+    for (unsigned int i = 0; i < BITS_PER_STRING; i++)
+    {
+        unsigned int bit = positions & 511;
+        all &= (block.words[bit >> 6] >> (bit & 63)) & 1;
+        positions = (positions >> 9) | (positions << 55);
+    }
+    return all;
+}
@@ -0,0 +1,100 @@
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "HashPolicies.hpp"
+#include "Prefetch.hpp"
+
+
+
+// A BloomFilter answers whether a string might be in a set, using a few
+// bits per string instead of the strings themselves.  It never says no to
+// a string that was added, but it says yes to a small fraction of those
+// that were not, so it is consulted first to throw out most misses
+// cheaply and the set is only asked about what gets through.
+//
+// The filter is blocked: all of a string's bits fall within one 64-byte
+// block, so checking a string touches a single cache line.
+class BloomFilter
+{
+public:
+    // How many bits of a block each string sets.
+    static constexpr unsigned int BITS_PER_STRING = 8;
+
+public:
+    // Initializes an empty filter sized for the given number of strings at
+    // the given number of bits per string.  Ten bits per string gives a
+    // false positive rate of around one percent.
+    explicit BloomFilter(unsigned int expectedCount, unsigned int bitsPerString = 10);
+
+
+    // add() adds a string to the filter.
+    void add(std::string_view s);
+
+
+    // mayContain() returns false if the string was certainly never added,
+    // true if it might have been.
+    bool mayContain(std::string_view s) const noexcept;
+
+
+    // mayContainMany() sets each entry of found to mayContain() of the
+    // corresponding key.  The keys' blocks are prefetched a batch at a
+    // time before any of them is tested.
+    template <typename K>
+    void mayContainMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // expectedFalsePositiveRate() estimates the fraction of strings never
+    // added for which mayContain() returns true, from how full the
+    // filter's blocks actually are.
+    double expectedFalsePositiveRate() const noexcept;
+
+
+    // memoryUsage() returns the approximate number of bytes the filter
+    // occupies.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    static constexpr unsigned int WORDS_PER_BLOCK = 8;
+    static constexpr unsigned int LOOKUP_BATCH_SIZE = 32;
+
+    struct alignas(64) Block
+    {
+        std::uint64_t words[WORDS_PER_BLOCK] = {};
+    };
+
+    std::vector<Block> blocks;
+
+    std::size_t blockOf(std::uint64_t hash) const noexcept;
+    bool test(const Block& block, std::uint64_t hash) const noexcept;
+};
+
+
+
+template <typename K>
+void BloomFilter::mayContainMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    found.assign(keys.size(), false);
+
+    std::uint64_t hashes[LOOKUP_BATCH_SIZE];
+    for (std::size_t first = 0; first < keys.size(); first += LOOKUP_BATCH_SIZE)
+    {
+        std::size_t count = std::min<std::size_t>(LOOKUP_BATCH_SIZE, keys.size() - first);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashes[i] = StringHash{}(std::string_view{keys[first+i]});
+            prefetch(&blocks[blockOf(hashes[i])]);
+        }
+        for (std::size_t i = 0; i < count; i++)
+            found[first+i] = test(blocks[blockOf(hashes[i])], hashes[i]);
+    }
+}
+
+
+
+#endif // BLOOMFILTER_HPP
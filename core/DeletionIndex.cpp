@@ -0,0 +1,171 @@
+#include "DeletionIndex.hpp"
+#include <algorithm>
+
+
+namespace
+{
+    unsigned int hashOf(std::string_view s)
+    {
+        // 32-bit FNV-1a.
+        unsigned int hash = 2166136261u;
+        for (char c : s)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+
+    // isOneEdit() returns true if near can be made from word by at most one
+    // adjacent swap, insertion, deletion or replacement, where any letter
+    // that near has in place of one of word's comes from alphabet.
+    bool isOneEdit(std::string_view word, std::string_view near, std::string_view alphabet)
+    {
+        auto inAlphabet = [&](char c) { return alphabet.find(c) != std::string_view::npos; };
+
+        std::size_t i = 0;
+        while (i < word.size() && i < near.size() && word[i] == near[i])
+            i++;
+
+        if (near.size() == word.size())
+        {
+            if (i == word.size())
+                return true;
+            if (word.substr(i + 1) == near.substr(i + 1))
+                return inAlphabet(near[i]);
+            return i + 1 < word.size() && word[i] == near[i+1] && word[i+1] == near[i]
+                && word.substr(i + 2) == near.substr(i + 2);
+        }
+        if (near.size() == word.size() + 1)
+            return inAlphabet(near[i]) && word.substr(i) == near.substr(i + 1);
+        if (near.size() + 1 == word.size())
+            return word.substr(i + 1) == near.substr(i);
+        return false;
+    }
+}
+
+
+DeletionIndex::DeletionIndex()
+    : offsets(1, 0), buckets(1024, NONE)
+{
+}
+
+
+void DeletionIndex::add(const std::string& word)
+{
+    unsigned int hash = hashOf(word);
+    if (indexed(word, hash))
+        return;
+
+    unsigned int index = offsets.size() - 1;
+    pool.append(word);
+    offsets.push_back(pool.size());
+
+    addVariant(hash, index);
+    std::string variant;
+    for (std::size_t i = 0; i < word.size(); i++)
+    {
+        // Deleting either letter of a doubled pair gives the same variant.
+        if (i + 1 < word.size() && word[i] == word[i+1])
+            continue;
+        variant.assign(word, 0, i);
+        variant.append(word, i + 1, std::string::npos);
+        addVariant(hashOf(variant), index);
+    }
+}
+
+
+unsigned int DeletionIndex::size() const noexcept
+{
+    return offsets.size() - 1;
+}
+
+
+std::size_t DeletionIndex::memoryUsage() const noexcept
+{
+    return pool.capacity()
+        + offsets.capacity() * sizeof(unsigned int)
+        + buckets.capacity() * sizeof(unsigned int)
+        + variants.capacity() * sizeof(variant);
+}
+
+
+void DeletionIndex::nearWords(
+    std::string_view word, std::string_view alphabet,
+    std::vector<std::string>& found) const
+{
+    std::size_t first = found.size();
+
+    collect(word, word, alphabet, found);
+    std::string key;
+    for (std::size_t i = 0; i < word.size(); i++)
+    {
+        if (i + 1 < word.size() && word[i] == word[i+1])
+            continue;
+        key.assign(word.substr(0, i));
+        key.append(word.substr(i + 1));
+        collect(key, word, alphabet, found);
+    }
+
+    // A word that shares several variants with the misspelling, like one
+    // that swaps two of its letters, is found once per shared variant.
+    std::sort(found.begin() + first, found.end());
+    found.erase(std::unique(found.begin() + first, found.end()), found.end());
+}
+
+
+std::string_view DeletionIndex::wordAt(unsigned int index) const
+{
+    return std::string_view{pool}.substr(offsets[index], offsets[index+1] - offsets[index]);
+}
+
+
+bool DeletionIndex::indexed(std::string_view word, unsigned int hash) const
+{
+    for (unsigned int v = buckets[hash & (buckets.size() - 1)]; v != NONE; v = variants[v].next)
+    {
+        if (variants[v].hash == hash && wordAt(variants[v].word) == word)
+            return true;
+    }
+    return false;
+}
+
+
+void DeletionIndex::addVariant(unsigned int hash, unsigned int word)
+{
+    if (variants.size() >= buckets.size())
+        grow();
+
+    unsigned int bucket = hash & (buckets.size() - 1);
+    variants.push_back(variant{hash, word, buckets[bucket]});
+    buckets[bucket] = variants.size() - 1;
+}
+
+
+void DeletionIndex::grow()
+{
+    buckets.assign(buckets.size() * 2, NONE);
+    for (unsigned int v = 0; v < variants.size(); v++)
+    {
+        unsigned int bucket = variants[v].hash & (buckets.size() - 1);
+        variants[v].next = buckets[bucket];
+        buckets[bucket] = v;
+    }
+}
+
+
+void DeletionIndex::collect(
+    std::string_view key, std::string_view word, std::string_view alphabet,
+    std::vector<std::string>& found) const
+{
+    unsigned int hash = hashOf(key);
+    for (unsigned int v = buckets[hash & (buckets.size() - 1)]; v != NONE; v = variants[v].next)
+    {
+        if (variants[v].hash != hash)
+            continue;
+        std::string_view near = wordAt(variants[v].word);
+        if (isOneEdit(word, near, alphabet))
+            found.emplace_back(near);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef DELETIONINDEX_HPP
+#define DELETIONINDEX_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// A DeletionIndex maps every word that can be made by deleting at most one
+// letter from a dictionary word back to the dictionary words it came from.
+// Two words are within one swap, insertion, deletion or replacement of each
+// other only if they have such a variant in common, so the near words of a
+// misspelling can be found by looking up the misspelling itself and each
+// of its own single-letter deletions, about n+1 lookups in all, instead of
+// probing for every candidate spelling.
+//
+// The index holds its own copy of the words, so it costs considerably more
+// memory than the set it is built alongside.
+class DeletionIndex
+{
+public:
+    // Initializes an empty DeletionIndex.
+    DeletionIndex();
+
+
+    // add() adds a dictionary word to the index.  Adding a word that is
+    // already in the index has no effect.
+    void add(const std::string& word);
+
+
+    // size() returns the number of words in the index.
+    unsigned int size() const noexcept;
+
+
+    // memoryUsage() returns the approximate number of bytes the index
+    // occupies.
+    std::size_t memoryUsage() const noexcept;
+
+
+    // nearWords() appends to found every indexed word that can be made from
+    // word by swapping two adjacent letters, inserting a letter, deleting a
+    // letter or replacing a letter, along with word itself if it is indexed.
+    // Only letters in alphabet count as inserted or replacement letters.
+    // Each word is appended once.
+    void nearWords(
+        std::string_view word, std::string_view alphabet,
+        std::vector<std::string>& found) const;
+
+
+private:
+    // Variants are chained per bucket through next; an index of NONE ends
+    // the chain.  Only the variant's hash is kept, and every word it leads
+    // to is checked against the misspelling, so a hash collision can never
+    // produce a wrong suggestion.
+    static constexpr unsigned int NONE = ~0u;
+
+    struct variant
+    {
+        unsigned int hash;
+        unsigned int word;
+        unsigned int next;
+    };
+
+    std::string pool;
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> buckets;
+    std::vector<variant> variants;
+
+    std::string_view wordAt(unsigned int index) const;
+    bool indexed(std::string_view word, unsigned int hash) const;
+    void addVariant(unsigned int hash, unsigned int word);
+    void grow();
+    void collect(
+        std::string_view key, std::string_view word, std::string_view alphabet,
+        std::vector<std::string>& found) const;
+};
+
+
+
+#endif // DELETIONINDEX_HPP
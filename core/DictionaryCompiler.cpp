@@ -0,0 +1,71 @@
+#include "DictionaryCompiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include "DictionaryFormat.hpp"
+
+
+void DictionaryCompiler::add(const std::string& word)
+{
+    words.push_back(word);
+}
+
+
+void DictionaryCompiler::write(const std::string& path)
+{
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // At most half of the slots are used, so that a lookup for a word
+    // that is not there reaches an empty slot quickly.
+    std::uint32_t slotCount = 16;
+    while (slotCount < words.size() * 2)
+        slotCount *= 2;
+
+    std::vector<DictionaryFormat::Slot> slots(slotCount, DictionaryFormat::Slot{0, DictionaryFormat::EMPTY, 0});
+    std::string pool;
+    for (const std::string& word : words)
+    {
+        if (pool.size() + word.size() >= DictionaryFormat::EMPTY)
+            throw DictionaryFileException{"dictionary is too large: " + path};
+
+        std::uint32_t hash = DictionaryFormat::hash(word);
+        std::uint32_t index = hash & (slotCount - 1);
+        while (slots[index].offset != DictionaryFormat::EMPTY)
+            index = (index + 1) & (slotCount - 1);
+
+        slots[index].hash = hash;
+        slots[index].offset = pool.size();
+        slots[index].length = word.size();
+        pool.append(word);
+    }
+
+    DictionaryFormat::Header header;
+    std::memcpy(header.magic, DictionaryFormat::MAGIC, sizeof(header.magic));
+    header.version = DictionaryFormat::VERSION;
+    header.byteOrder = DictionaryFormat::ENDIAN_MARK;
+    header.wordCount = words.size();
+    header.slotCount = slotCount;
+    header.slotsOffset = sizeof(header);
+    header.poolOffset = header.slotsOffset + slots.size() * sizeof(DictionaryFormat::Slot);
+    header.poolSize = pool.size();
+    header.fileSize = header.poolOffset + header.poolSize;
+
+    // The file is written under a temporary name next to it and then
+    // renamed over path, so that a process that has the old file mapped
+    // keeps reading the old file rather than one being rewritten under it.
+    std::string temporaryPath = path + ".tmp." + std::to_string(getpid());
+    std::ofstream out{temporaryPath, std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(DictionaryFormat::Slot));
+    out.write(pool.data(), pool.size());
+    out.flush();
+    out.close();
+    if (!out || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        throw DictionaryFileException{"could not write dictionary: " + path};
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef DICTIONARYCOMPILER_HPP
+#define DICTIONARYCOMPILER_HPP
+
+#include <string>
+#include <vector>
+
+
+
+// A DictionaryCompiler collects a dictionary's words and writes them out as
+// a compiled dictionary file (see DictionaryFormat.hpp), which a MappedSet
+// can then open without building anything.
+class DictionaryCompiler
+{
+public:
+    // add() adds a word to the dictionary.  Adding a word more than once
+    // has the same effect as adding it once.
+    void add(const std::string& word);
+
+
+    // write() writes the dictionary to the file at the given path,
+    // replacing it if it exists.  The old file is replaced in one step,
+    // so processes that have it mapped are not disturbed.  A
+    // DictionaryFileException is thrown if the file cannot be written.
+    void write(const std::string& path);
+
+
+private:
+    std::vector<std::string> words;
+};
+
+
+
+#endif // DICTIONARYCOMPILER_HPP
@@ -0,0 +1,85 @@
+#ifndef DICTIONARYFORMAT_HPP
+#define DICTIONARYFORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+
+// A compiled dictionary file holds a header, then an open-addressing table
+// of slots, then a pool of the words' characters.  Every location in the
+// file is an offset from its start, so the file can be mapped anywhere in
+// memory and used as it is.  Numbers are stored in the byte order of the
+// machine that wrote the file; byteOrder lets a reader detect a mismatch.
+namespace DictionaryFormat
+{
+    constexpr char MAGIC[8] = {'W', 'C', 'D', 'I', 'C', 'T', '\0', '\0'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t ENDIAN_MARK = 0x01020304;
+
+    // A slot whose offset is EMPTY holds no word.
+    constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t wordCount;
+        std::uint32_t slotCount;
+        std::uint64_t slotsOffset;
+        std::uint64_t poolOffset;
+        std::uint64_t poolSize;
+        std::uint64_t fileSize;
+    };
+
+
+    struct Slot
+    {
+        std::uint32_t hash;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+
+    // hash() is the hash that slots are placed by.  It is part of the file
+    // format, so it must never change without changing VERSION.
+    inline std::uint32_t hash(std::string_view word) noexcept
+    {
+        // 32-bit FNV-1a.
+        std::uint32_t h = 2166136261u;
+        for (char c : word)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+}
+
+
+
+// A DictionaryFileException is thrown when a compiled dictionary cannot be
+// written, read or modified.
+class DictionaryFileException
+{
+public:
+    DictionaryFileException(const std::string& reason)
+        : reason_{reason}
+    {
+    }
+
+    const std::string& reason() const
+    {
+        return reason_;
+    }
+
+private:
+    std::string reason_;
+};
+
+
+
+#endif // DICTIONARYFORMAT_HPP
@@ -0,0 +1,220 @@
+#include "DictionaryHandle.hpp"
+#include <algorithm>
+#include <limits>
+
+
+struct DictionaryHandle::Snapshot::Version
+{
+    std::unique_ptr<const Set<std::string>> words;
+    unsigned long long number;
+};
+
+
+namespace
+{
+    // Every thread that reads announces its epoch in a slot of its own.
+    // Slots are allocated as threads first read, handed back when they
+    // exit, and never freed, so the list can be walked without locking.
+    // An epoch of IDLE means the thread is not reading.
+    constexpr unsigned long long IDLE = 0;
+
+    struct ReaderSlot
+    {
+        alignas(64) std::atomic<unsigned long long> epoch{IDLE};
+        std::atomic<bool> claimed{false};
+        ReaderSlot* next = nullptr;
+    };
+
+    // Handles share one epoch and one set of slots.  A reader of one
+    // handle can then delay reclamation in another, but never by more
+    // than the length of its own read.
+    std::atomic<unsigned long long> globalEpoch{1};
+    std::atomic<ReaderSlot*> slots{nullptr};
+
+
+    ReaderSlot* claimSlot()
+    {
+        for (ReaderSlot* slot = slots.load(); slot != nullptr; slot = slot->next)
+        {
+            bool expected = false;
+            if (slot->claimed.compare_exchange_strong(expected, true))
+                return slot;
+        }
+
+        ReaderSlot* slot = new ReaderSlot;
+        slot->claimed.store(true);
+        slot->next = slots.load();
+        while (!slots.compare_exchange_weak(slot->next, slot))
+        {
+        }
+        return slot;
+    }
+
+
+    struct ThreadReader
+    {
+        ReaderSlot* slot = nullptr;
+        unsigned int depth = 0;
+
+        ~ThreadReader()
+        {
+            if (slot != nullptr)
+            {
+                slot->epoch.store(IDLE);
+                slot->claimed.store(false);
+            }
+        }
+    };
+
+
+    ThreadReader& threadReader()
+    {
+        thread_local ThreadReader reader;
+        if (reader.slot == nullptr)
+            reader.slot = claimSlot();
+        return reader;
+    }
+
+
+    unsigned long long oldestReaderEpoch()
+    {
+        unsigned long long oldest = std::numeric_limits<unsigned long long>::max();
+        for (ReaderSlot* slot = slots.load(); slot != nullptr; slot = slot->next)
+        {
+            unsigned long long epoch = slot->epoch.load();
+            if (epoch != IDLE)
+                oldest = std::min(oldest, epoch);
+        }
+        return oldest;
+    }
+}
+
+
+DictionaryHandle::Snapshot::Snapshot(const Version* version) noexcept
+    : current{version}
+{
+}
+
+
+DictionaryHandle::Snapshot::Snapshot(Snapshot&& s) noexcept
+    : current{s.current}
+{
+    s.current = nullptr;
+}
+
+
+DictionaryHandle::Snapshot::~Snapshot() noexcept
+{
+    if (current == nullptr)
+        return;
+
+    ThreadReader& reader = threadReader();
+    if (--reader.depth == 0)
+        reader.slot->epoch.store(IDLE);
+}
+
+
+const Set<std::string>& DictionaryHandle::Snapshot::words() const noexcept
+{
+    return *current->words;
+}
+
+
+unsigned long long DictionaryHandle::Snapshot::version() const noexcept
+{
+    return current->number;
+}
+
+
+DictionaryHandle::DictionaryHandle(std::unique_ptr<const Set<std::string>> words)
+    : current{new Snapshot::Version{std::move(words), 1}}, versions{1}, cache{nullptr}
+{
+}
+
+
+DictionaryHandle::~DictionaryHandle() noexcept
+{
+    delete current.load();
+    for (const Retired& r : retired)
+        delete r.version;
+}
+
+
+DictionaryHandle::Snapshot DictionaryHandle::snapshot() const
+{
+    // The epoch is announced before the version is loaded.  A writer that
+    // retires a version after this load bumps the epoch first, so it sees
+    // this announcement and keeps the version alive; a writer that
+    // retired it earlier already published a newer one, which is what the
+    // load then returns.
+    ThreadReader& reader = threadReader();
+    if (reader.depth++ == 0)
+        reader.slot->epoch.store(globalEpoch.load());
+    return Snapshot{current.load()};
+}
+
+
+void DictionaryHandle::publish(std::unique_ptr<const Set<std::string>> words)
+{
+    const Snapshot::Version* replacement = new Snapshot::Version{std::move(words), ++versions};
+    const Snapshot::Version* replaced = current.exchange(replacement);
+
+    if (SuggestionCache* c = cache.load())
+        c->invalidate();
+
+    // Any reader that can still see the replaced version announced an
+    // epoch no later than this one.
+    unsigned long long epoch = globalEpoch.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock{retiredMutex};
+        retired.push_back(Retired{replaced, epoch});
+    }
+    reclaim();
+}
+
+
+std::future<void> DictionaryHandle::reloadAsync(std::function<std::unique_ptr<const Set<std::string>>()> build)
+{
+    return std::async(std::launch::async, [this, build]
+    {
+        publish(build());
+    });
+}
+
+
+unsigned long long DictionaryHandle::version() const noexcept
+{
+    return current.load()->number;
+}
+
+
+std::size_t DictionaryHandle::retiredCount() const
+{
+    std::lock_guard<std::mutex> lock{retiredMutex};
+    return retired.size();
+}
+
+
+void DictionaryHandle::reclaim()
+{
+    std::vector<const Snapshot::Version*> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock{retiredMutex};
+        unsigned long long oldest = oldestReaderEpoch();
+        auto stillVisible = std::partition(retired.begin(), retired.end(),
+            [oldest](const Retired& r) { return r.epoch >= oldest; });
+        for (auto r = stillVisible; r != retired.end(); ++r)
+            reclaimable.push_back(r->version);
+        retired.erase(stillVisible, retired.end());
+    }
+
+    // Sets can be large, so they are destroyed outside the lock.
+    for (const Snapshot::Version* version : reclaimable)
+        delete version;
+}
+
+
+void DictionaryHandle::useSuggestionCache(SuggestionCache* cache) noexcept
+{
+    this->cache.store(cache);
+}
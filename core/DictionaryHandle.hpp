@@ -0,0 +1,128 @@
+#ifndef DICTIONARYHANDLE_HPP
+#define DICTIONARYHANDLE_HPP
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Set.hpp"
+#include "SuggestionCache.hpp"
+
+
+
+// A DictionaryHandle holds the current version of a dictionary that can be
+// replaced while other threads are reading it.
+//
+// Readers call snapshot() and use the set it gives them for as long as the
+// snapshot lives, typically by building a WordChecker on it for one call:
+//
+//     DictionaryHandle::Snapshot snapshot = handle.snapshot();
+//     WordChecker checker{snapshot.words()};
+//     std::vector<std::string> suggestions = checker.findSuggestions(word);
+//
+// Taking and releasing a snapshot never waits for anything and never takes
+// a lock.  A writer builds a new set off to the side and publishes it; the
+// version it replaces is destroyed once no snapshot that could still be
+// using it remains.  This is epoch-based reclamation: each reading thread
+// announces the epoch it started reading in, and a retired version is
+// destroyed once every announced epoch is later than the one it was
+// retired in.
+class DictionaryHandle
+{
+public:
+    class Snapshot
+    {
+    public:
+        Snapshot(Snapshot&& s) noexcept;
+        ~Snapshot() noexcept;
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        // words() returns the dictionary as it was when the snapshot was
+        // taken.
+        const Set<std::string>& words() const noexcept;
+
+        // version() returns the number of the version this snapshot is
+        // of.  Every publish() produces a higher number.
+        unsigned long long version() const noexcept;
+
+    private:
+        friend class DictionaryHandle;
+        struct Version;
+
+        explicit Snapshot(const Version* version) noexcept;
+
+        const Version* current;
+    };
+
+public:
+    // Initializes a handle whose first version is the given set.
+    explicit DictionaryHandle(std::unique_ptr<const Set<std::string>> words);
+
+    // Destroys every version.  No snapshot of this handle may outlive it.
+    ~DictionaryHandle() noexcept;
+
+    DictionaryHandle(const DictionaryHandle&) = delete;
+    DictionaryHandle& operator=(const DictionaryHandle&) = delete;
+
+
+    // snapshot() returns a snapshot of the current version.  A snapshot
+    // must be destroyed on the thread that took it.
+    Snapshot snapshot() const;
+
+
+    // publish() makes the given set the current version.  Snapshots taken
+    // before it returns may still see the previous version.
+    void publish(std::unique_ptr<const Set<std::string>> words);
+
+
+    // reloadAsync() calls build on a new thread and publishes the set it
+    // returns.  The returned future becomes ready once it has been
+    // published, and rethrows anything that build threw.
+    std::future<void> reloadAsync(std::function<std::unique_ptr<const Set<std::string>>()> build);
+
+
+    // version() returns the number of the current version.
+    unsigned long long version() const noexcept;
+
+
+    // retiredCount() returns how many replaced versions have not been
+    // destroyed yet because a snapshot may still be using them.
+    std::size_t retiredCount() const;
+
+
+    // reclaim() destroys every replaced version that no snapshot can still
+    // be using.  publish() does this too, so it is only needed to free
+    // versions sooner once long-running snapshots have been released.
+    void reclaim();
+
+
+    // useSuggestionCache() makes publish() invalidate the given cache once
+    // the new version is current, so that no suggestions found in an
+    // earlier version are returned for it.  Passing nullptr stops it.
+    void useSuggestionCache(SuggestionCache* cache) noexcept;
+
+
+private:
+    struct Retired
+    {
+        const Snapshot::Version* version;
+        unsigned long long epoch;
+    };
+
+    std::atomic<const Snapshot::Version*> current;
+    std::atomic<unsigned long long> versions;
+    std::atomic<SuggestionCache*> cache;
+
+    mutable std::mutex retiredMutex;
+    std::vector<Retired> retired;
+};
+
+
+
+#endif // DICTIONARYHANDLE_HPP
@@ -0,0 +1,413 @@
+#include "EditDistanceIndex.hpp"
+#include <algorithm>
+#include "EditDistanceKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define EDITDISTANCE_X86 1
+#endif
+
+
+namespace
+{
+    using EditDistanceKernels::LANES;
+    using EditDistanceKernels::Dispatch;
+
+    // How many signatures are filtered between looks at the clock.
+    constexpr std::size_t BLOCK_SIZE = 1024;
+
+
+    // Without the popcnt instruction, the compiler's builtin becomes a call
+    // into its runtime library, which is slower than counting in place.
+    unsigned int countBits(std::uint64_t x)
+    {
+#if defined(__POPCNT__) && (defined(__GNUC__) || defined(__clang__))
+        return static_cast<unsigned int>(__builtin_popcountll(x));
+#else
+        x = x - ((x >> 1) & 0x5555555555555555);
+        x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0F;
+        return static_cast<unsigned int>((x * 0x0101010101010101) >> 56);
+#endif
+    }
+
+
+    // The signature filters store every index and only count those that
+    // pass, so that they do not branch on each signature.
+    std::size_t filterScalar(
+        const std::uint64_t* signatures, std::size_t count, std::uint64_t target,
+        unsigned int maxBits, std::uint32_t* passed)
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            passed[n] = static_cast<std::uint32_t>(i);
+            n += countBits(signatures[i] ^ target) <= maxBits;
+        }
+        return n;
+    }
+
+
+    // The kernels follow Hyyrö's bit-parallel form of the restricted
+    // Damerau-Levenshtein distance.  Bit i of the vertical deltas vp and vn
+    // says whether the distance from the misspelling's first i+1 letters
+    // to the word's first j letters is one more or one less than from its
+    // first i letters, and each of the word's letters updates every bit at
+    // once.  The distance from the whole misspelling is tracked through
+    // bit m-1 of the horizontal deltas.  tr marks where swapping the
+    // word's last two letters matches the misspelling.  Bits above m-1 are
+    // garbage, but carries only move up, so they never reach bit m-1.
+    void compareScalar(
+        const std::uint64_t* peq, unsigned int m, const char* const* words, unsigned int n,
+        unsigned int* distances)
+    {
+        const std::uint64_t top = std::uint64_t{1} << (m - 1);
+
+        std::uint64_t vp[LANES];
+        std::uint64_t vn[LANES];
+        std::uint64_t d0[LANES];
+        std::uint64_t previous[LANES];
+        for (unsigned int lane = 0; lane < LANES; lane++)
+        {
+            vp[lane] = ~std::uint64_t{0};
+            vn[lane] = 0;
+            d0[lane] = 0;
+            previous[lane] = 0;
+            distances[lane] = m;
+        }
+
+        for (unsigned int j = 0; j < n; j++)
+        {
+            for (unsigned int lane = 0; lane < LANES; lane++)
+            {
+                std::uint64_t pm = peq[static_cast<unsigned char>(words[lane][j])];
+                std::uint64_t tr = ((~d0[lane] & pm) << 1) & previous[lane];
+                d0[lane] = (((pm & vp[lane]) + vp[lane]) ^ vp[lane]) | pm | vn[lane] | tr;
+
+                std::uint64_t hp = vn[lane] | ~(d0[lane] | vp[lane]);
+                std::uint64_t hn = d0[lane] & vp[lane];
+                distances[lane] += (hp & top) != 0;
+                distances[lane] -= (hn & top) != 0;
+
+                hp = (hp << 1) | 1;
+                hn = hn << 1;
+                vp[lane] = hn | ~(d0[lane] | hp);
+                vn[lane] = d0[lane] & hp;
+                previous[lane] = pm;
+            }
+        }
+    }
+
+
+#ifdef EDITDISTANCE_X86
+#if defined(__GNUC__) || defined(__clang__)
+    // The same steps, with each word in a 64-bit lane of its own.  The
+    // masks for the four words' letters are gathered from peq one at a
+    // time, since the words' letters differ.
+    __attribute__((target("avx2")))
+    void compareAvx2(
+        const std::uint64_t* peq, unsigned int m, const char* const* words, unsigned int n,
+        unsigned int* distances)
+    {
+        const __m256i ones = _mm256_set1_epi64x(-1);
+        const __m256i one = _mm256_set1_epi64x(1);
+        const __m256i top = _mm256_set1_epi64x(static_cast<long long>(std::uint64_t{1} << (m - 1)));
+
+        __m256i vp = ones;
+        __m256i vn = _mm256_setzero_si256();
+        __m256i d0 = _mm256_setzero_si256();
+        __m256i previous = _mm256_setzero_si256();
+        __m256i distance = _mm256_set1_epi64x(m);
+
+        for (unsigned int j = 0; j < n; j++)
+        {
+            __m256i pm = _mm256_set_epi64x(
+                static_cast<long long>(peq[static_cast<unsigned char>(words[3][j])]),
+                static_cast<long long>(peq[static_cast<unsigned char>(words[2][j])]),
+                static_cast<long long>(peq[static_cast<unsigned char>(words[1][j])]),
+                static_cast<long long>(peq[static_cast<unsigned char>(words[0][j])]));
+
+            __m256i tr = _mm256_and_si256(_mm256_slli_epi64(_mm256_andnot_si256(d0, pm), 1), previous);
+            __m256i sum = _mm256_add_epi64(_mm256_and_si256(pm, vp), vp);
+            d0 = _mm256_or_si256(
+                _mm256_or_si256(_mm256_xor_si256(sum, vp), pm), _mm256_or_si256(vn, tr));
+
+            __m256i hp = _mm256_or_si256(vn, _mm256_xor_si256(_mm256_or_si256(d0, vp), ones));
+            __m256i hn = _mm256_and_si256(d0, vp);
+
+            // A lane compares equal to all ones, which is -1, where its top
+            // bit is set.
+            distance = _mm256_sub_epi64(distance, _mm256_cmpeq_epi64(_mm256_and_si256(hp, top), top));
+            distance = _mm256_add_epi64(distance, _mm256_cmpeq_epi64(_mm256_and_si256(hn, top), top));
+
+            hp = _mm256_or_si256(_mm256_slli_epi64(hp, 1), one);
+            hn = _mm256_slli_epi64(hn, 1);
+            vp = _mm256_or_si256(hn, _mm256_xor_si256(_mm256_or_si256(d0, hp), ones));
+            vn = _mm256_and_si256(d0, hp);
+            previous = pm;
+        }
+
+        alignas(32) std::uint64_t lanes[LANES];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), distance);
+        for (unsigned int lane = 0; lane < LANES; lane++)
+            distances[lane] = static_cast<unsigned int>(lanes[lane]);
+    }
+
+
+    // Bits are counted a nibble at a time by looking them up in a table
+    // with a shuffle, and the counts summed per lane.
+    __attribute__((target("avx2")))
+    std::size_t filterAvx2(
+        const std::uint64_t* signatures, std::size_t count, std::uint64_t target,
+        unsigned int maxBits, std::uint32_t* passed)
+    {
+        const __m256i table = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i targets = _mm256_set1_epi64x(static_cast<long long>(target));
+        const __m256i limit = _mm256_set1_epi64x(maxBits);
+
+        std::size_t n = 0;
+        std::size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            __m256i x = _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(signatures + i)), targets);
+            __m256i bits = _mm256_add_epi8(
+                _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+                _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+            __m256i sums = _mm256_sad_epu8(bits, _mm256_setzero_si256());
+
+            unsigned int far = static_cast<unsigned int>(
+                _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(sums, limit))));
+            for (unsigned int near = ~far & 0xF; near != 0; near &= near - 1)
+                passed[n++] = static_cast<std::uint32_t>(i + __builtin_ctz(near));
+        }
+        for (; i < count; i++)
+        {
+            passed[n] = static_cast<std::uint32_t>(i);
+            n += countBits(signatures[i] ^ target) <= maxBits;
+        }
+        return n;
+    }
+#define EDITDISTANCE_AVX2 1
+#endif
+#endif
+
+
+    // The best kernel and filter for the processor the program is running
+    // on are found once.
+    Dispatch chooseKernel()
+    {
+#ifdef EDITDISTANCE_AVX2
+        if (__builtin_cpu_supports("avx2"))
+            return {compareAvx2, filterAvx2, "avx2"};
+#endif
+        return {compareScalar, filterScalar, "scalar"};
+    }
+
+    const Dispatch best = chooseKernel();
+    const Dispatch scalar = {compareScalar, filterScalar, "scalar"};
+
+
+}
+
+
+namespace EditDistanceKernels
+{
+    Dispatch scalar() noexcept
+    {
+        return ::scalar;
+    }
+
+
+    Dispatch best() noexcept
+    {
+        return ::best;
+    }
+}
+
+
+EditDistanceIndex::EditDistanceIndex(bool vectorized)
+    : count{0},
+      kernel{vectorized ? best.kernel : scalar.kernel},
+      filter{vectorized ? best.filter : scalar.filter},
+      name{vectorized ? best.name : scalar.name}
+{
+}
+
+
+void EditDistanceIndex::add(const std::string& word)
+{
+    // The empty word is never a useful suggestion.
+    if (word.empty())
+        return;
+
+    if (word.size() >= buckets.size())
+        buckets.resize(word.size() + 1);
+
+    Bucket& bucket = buckets[word.size()];
+    bucket.letters.append(word);
+    bucket.signatures.push_back(signature(word));
+    count++;
+}
+
+
+unsigned int EditDistanceIndex::size() const noexcept
+{
+    return count;
+}
+
+
+std::size_t EditDistanceIndex::memoryUsage() const noexcept
+{
+    std::size_t bytes = sizeof(*this) + buckets.capacity() * sizeof(Bucket);
+    for (const Bucket& bucket : buckets)
+    {
+        bytes += bucket.letters.capacity();
+        bytes += bucket.signatures.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
+
+
+bool EditDistanceIndex::nearWords(
+    std::string_view word, unsigned int maxDistance, std::chrono::nanoseconds budget,
+    std::vector<NearWord>& found) const
+{
+    if (word.size() > MAX_WORD_LENGTH)
+        return false;
+
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+    const unsigned int m = static_cast<unsigned int>(word.size());
+
+    // peq holds, for every letter, a mask of where it is in the word.
+    std::uint64_t peq[256] = {};
+    for (unsigned int i = 0; i < m; i++)
+        peq[static_cast<unsigned char>(word[i])] |= std::uint64_t{1} << i;
+
+    // The lengths nearest the word's are scanned first, since the words
+    // they hold are more likely to be near it, so that a scan that runs
+    // out of time has found the best of what it could.
+    std::size_t first = found.size();
+    bool complete = true;
+    for (unsigned int delta = 0; delta <= maxDistance && complete; delta++)
+    {
+        if (delta <= m && m - delta < buckets.size())
+            complete = scan(buckets[m - delta], m - delta, word, peq, maxDistance, budget, deadline, found);
+
+        if (delta > 0 && complete && m + delta < buckets.size())
+            complete = scan(buckets[m + delta], m + delta, word, peq, maxDistance, budget, deadline, found);
+    }
+
+    // Duplicates of a word are at the same distance, so once sorted they
+    // are next to each other.
+    auto nearer = [](const NearWord& a, const NearWord& b)
+    {
+        return a.distance != b.distance ? a.distance < b.distance : a.word < b.word;
+    };
+    auto same = [](const NearWord& a, const NearWord& b)
+    {
+        return a.word == b.word;
+    };
+    std::sort(found.begin() + first, found.end(), nearer);
+    found.erase(std::unique(found.begin() + first, found.end(), same), found.end());
+
+    return complete;
+}
+
+
+const char* EditDistanceIndex::instructionSet() const noexcept
+{
+    return name;
+}
+
+
+std::uint64_t EditDistanceIndex::signature(std::string_view word) noexcept
+{
+    // Letters are told apart by their low five bits, which folds case and
+    // shares bits among other bytes.  Any such folding can only make the
+    // signatures of near words closer, so it never hides a near word.
+    unsigned char counts[32] = {};
+    std::uint64_t once = 0;
+    std::uint64_t twice = 0;
+    for (char c : word)
+    {
+        unsigned int letter = static_cast<unsigned char>(c) & 31;
+        if (counts[letter] < 2)
+            counts[letter]++;
+
+        if (counts[letter] == 1)
+            once |= std::uint64_t{1} << letter;
+        else
+            twice |= std::uint64_t{1} << letter;
+    }
+    return once | (twice << 32);
+}
+
+
+bool EditDistanceIndex::scan(
+    const Bucket& bucket, unsigned int n, std::string_view word, const std::uint64_t* peq,
+    unsigned int maxDistance, std::chrono::nanoseconds budget,
+    std::chrono::steady_clock::time_point deadline, std::vector<NearWord>& found) const
+{
+    // An insertion or deletion changes one letter's count by one, flipping
+    // at most one bit of the signature, a replacement changes two letters'
+    // counts and a swap changes none, so words whose signatures are more
+    // than twice maxDistance bits apart are too far away.
+    const std::uint64_t target = signature(word);
+    const unsigned int maxBits = 2 * maxDistance;
+    const unsigned int m = static_cast<unsigned int>(word.size());
+
+    const char* words[LANES];
+    unsigned int distances[LANES];
+    unsigned int pending = 0;
+
+    auto compare = [&]
+    {
+        // A partly filled batch is padded out with copies of its first word,
+        // whose distances are ignored.
+        for (unsigned int lane = pending; lane < LANES; lane++)
+            words[lane] = words[0];
+
+        if (m == 0)
+            std::fill(distances, distances + LANES, n);
+        else
+            kernel(peq, m, words, n, distances);
+
+        for (unsigned int lane = 0; lane < pending; lane++)
+        {
+            if (distances[lane] <= maxDistance)
+                found.push_back(NearWord{std::string{words[lane], n}, distances[lane]});
+        }
+        pending = 0;
+    };
+
+    // The signatures are filtered a block at a time, and the clock is only
+    // looked at between blocks.
+    std::uint32_t passed[BLOCK_SIZE];
+    const std::size_t total = bucket.signatures.size();
+    for (std::size_t start = 0; start < total; start += BLOCK_SIZE)
+    {
+        if (budget.count() > 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            if (pending > 0)
+                compare();
+            return false;
+        }
+
+        std::size_t count = std::min(BLOCK_SIZE, total - start);
+        std::size_t near = filter(bucket.signatures.data() + start, count, target, maxBits, passed);
+        for (std::size_t i = 0; i < near; i++)
+        {
+            words[pending++] = bucket.letters.data() + (start + passed[i]) * n;
+            if (pending == LANES)
+                compare();
+        }
+    }
+
+    if (pending > 0)
+        compare();
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef EDITDISTANCEINDEX_HPP
+#define EDITDISTANCEINDEX_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// An EditDistanceIndex finds the dictionary words within a few edits of a
+// misspelling, counting a swap of two adjacent letters, an insertion, a
+// deletion or a replacement as one edit each.  Generating every spelling
+// two edits away and probing for it would take hundreds of thousands of
+// lookups per word, so the index instead scans the words themselves.
+//
+// The words are kept grouped by length, each with a signature of which
+// letters it has at least once and at least twice.  An edit changes the
+// length by at most one and at most two bits of the signature, so only
+// the words whose lengths and signatures are close enough to the
+// misspelling's are compared with it at all.  Those are compared by
+// Hyyrö's bit-parallel edit distance, which handles one letter of a word
+// per step for misspellings of up to 64 letters; with AVX2, four words of
+// the same length are compared at once, one per 64-bit lane.
+//
+// A scan can be given a time budget, after which it stops with whatever
+// it has found, nearest lengths first.
+class EditDistanceIndex
+{
+public:
+    // The longest misspelling that can be looked up.
+    static constexpr unsigned int MAX_WORD_LENGTH = 64;
+
+    // How long a checker lets a scan run when it is not told otherwise.
+    static constexpr std::chrono::microseconds DEFAULT_BUDGET{1000};
+
+    // A NearWord is an indexed word and its distance from a misspelling.
+    struct NearWord
+    {
+        std::string word;
+        unsigned int distance;
+    };
+
+public:
+    // Initializes an empty EditDistanceIndex.  Passing false for
+    // vectorized makes it compare one word at a time even when the
+    // processor has vector instructions, which is mainly useful for
+    // comparison.
+    explicit EditDistanceIndex(bool vectorized = true);
+
+
+    // add() adds a dictionary word to the index.  A word added more than
+    // once is still only found once.
+    void add(const std::string& word);
+
+
+    // size() returns the number of words added to the index.
+    unsigned int size() const noexcept;
+
+
+    // memoryUsage() returns the approximate number of bytes the index
+    // occupies.
+    std::size_t memoryUsage() const noexcept;
+
+
+    // nearWords() appends to found every indexed word within maxDistance
+    // edits of word, including word itself if it is indexed, nearest first
+    // and alphabetically among words at the same distance.  It returns
+    // true if the whole index was scanned, or false if the budget ran out
+    // first or word is longer than MAX_WORD_LENGTH, in which case only
+    // some of the near words, or none, are appended.  A budget of zero
+    // means no limit.
+    bool nearWords(
+        std::string_view word, unsigned int maxDistance, std::chrono::nanoseconds budget,
+        std::vector<NearWord>& found) const;
+
+
+    // instructionSet() returns the name of the instructions that
+    // nearWords() compares words with: "avx2" or "scalar".
+    const char* instructionSet() const noexcept;
+
+
+private:
+    // A Kernel finds the distances between a misspelling of length m, whose
+    // letters' positions are given as bit masks by peq, and four words of
+    // length n.
+    typedef void (*Kernel)(
+        const std::uint64_t* peq, unsigned int m, const char* const* words, unsigned int n,
+        unsigned int* distances);
+
+    // A Filter stores in passed the indexes of the signatures that differ
+    // from target in at most maxBits bits, returning how many there are.
+    typedef std::size_t (*Filter)(
+        const std::uint64_t* signatures, std::size_t count, std::uint64_t target,
+        unsigned int maxBits, std::uint32_t* passed);
+
+    // The words of one length, stored back to back without separators,
+    // and their signatures.
+    struct Bucket
+    {
+        std::string letters;
+        std::vector<std::uint64_t> signatures;
+    };
+
+    std::vector<Bucket> buckets;
+    unsigned int count;
+    Kernel kernel;
+    Filter filter;
+    const char* name;
+
+    static std::uint64_t signature(std::string_view word) noexcept;
+    bool scan(
+        const Bucket& bucket, unsigned int n, std::string_view word, const std::uint64_t* peq,
+        unsigned int maxDistance, std::chrono::nanoseconds budget,
+        std::chrono::steady_clock::time_point deadline, std::vector<NearWord>& found) const;
+};
+
+
+
+#endif // EDITDISTANCEINDEX_HPP
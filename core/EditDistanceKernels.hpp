@@ -0,0 +1,48 @@
+#ifndef EDITDISTANCEKERNELS_HPP
+#define EDITDISTANCEKERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+
+// EditDistanceKernels exposes the distance kernels and signature filters
+// that EditDistanceIndex chooses among at run time, so that
+// bench/KernelCheck can compare them.  It is not part of
+// EditDistanceIndex's interface; nothing else should include it.
+namespace EditDistanceKernels
+{
+    // How many words a kernel compares at once, one per lane.
+    constexpr unsigned int LANES = 4;
+
+    // A Kernel finds the distances between a misspelling of length m,
+    // whose letters' positions are given as bit masks by peq, and LANES
+    // words of length n.
+    typedef void (*Kernel)(
+        const std::uint64_t* peq, unsigned int m, const char* const* words, unsigned int n,
+        unsigned int* distances);
+
+    // A Filter stores in passed the indexes of the signatures that differ
+    // from target in at most maxBits bits, returning how many there are.
+    typedef std::size_t (*Filter)(
+        const std::uint64_t* signatures, std::size_t count, std::uint64_t target,
+        unsigned int maxBits, std::uint32_t* passed);
+
+    struct Dispatch
+    {
+        Kernel kernel;
+        Filter filter;
+        const char* name;
+    };
+
+
+    // scalar() returns the kernel and filter that use no vector
+    // instructions, and best() the ones that EditDistanceIndex uses by
+    // default on the processor the program is running on.
+    Dispatch scalar() noexcept;
+    Dispatch best() noexcept;
+}
+
+
+
+#endif // EDITDISTANCEKERNELS_HPP
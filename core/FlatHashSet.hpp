@@ -0,0 +1,480 @@
+#ifndef FLATHASHSET_HPP
+#define FLATHASHSET_HPP
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "HashPolicies.hpp"
+#include "Prefetch.hpp"
+#include "Set.hpp"
+#include "SetVersion.hpp"
+#include "Stats.hpp"
+
+
+
+// FlatHashSet is an open-addressing alternative to HashSet.  Elements live
+// directly in one contiguous array instead of in separately allocated chain
+// nodes, and collisions are resolved with Robin Hood linear probing.  Each
+// slot's hash is kept in a parallel metadata array, so a probe only compares
+// elements whose full hash already matches.
+//
+// The HashPolicy hashes elements, as it does for HashSet.
+template <typename T, typename HashPolicy = DefaultHash<T>>
+class FlatHashSet : public Set<T>
+{
+public:
+    // The default capacity of the FlatHashSet before anything has been
+    // added to it.  Capacities are always powers of two.
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+
+    // The hash policy, and the type of the hashes it returns.
+    typedef HashPolicy HashPolicyType;
+    typedef decltype(std::declval<const HashPolicy&>()(std::declval<const T&>())) HashValue;
+
+public:
+    // Initializes a FlatHashSet to be empty, so that it will use the given
+    // hash policy whenever it needs to hash an element.
+    explicit FlatHashSet(const HashPolicy& hashPolicy = HashPolicy());
+
+    // Cleans up the FlatHashSet so that it leaks no memory.
+    virtual ~FlatHashSet() noexcept;
+
+    // Initializes a new FlatHashSet to be a copy of an existing one.
+    FlatHashSet(const FlatHashSet& s);
+
+    // Initializes a new FlatHashSet whose contents are moved from an
+    // expiring one.  The expiring one is left empty, with no table at
+    // all until something is added to it.
+    FlatHashSet(FlatHashSet&& s) noexcept;
+
+    // Assigns an existing FlatHashSet into another.
+    FlatHashSet& operator=(const FlatHashSet& s);
+
+    // Assigns an expiring FlatHashSet into another.
+    FlatHashSet& operator=(FlatHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const T& element) const override;
+
+
+    // This version of contains() accepts any key that can be compared with
+    // a T, such as a std::string_view for a FlatHashSet<std::string>.  Keys
+    // are hashed as they are by HashSet's version.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.  The keys are hashed and
+    // their home slots prefetched a batch at a time before any of them is
+    // compared.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // containsHashed() is contains() for a key whose hash is already known,
+    // as it is when it was derived from the hash of a similar key.  The
+    // hash must be the one the set's hash policy returns for the key.
+    template <typename K>
+    bool containsHashed(HashValue hash, const K& key) const;
+
+
+    // containsManyHashed() is containsMany() for keys whose hashes are
+    // already known; hashes[i] must be the hash of keys[i].
+    template <typename K>
+    void containsManyHashed(
+        const std::vector<K>& keys, const std::vector<HashValue>& hashes,
+        std::vector<bool>& found) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // version() returns a number that changes whenever the set's elements
+    // might have (see SetVersion.hpp).
+    unsigned long long version() const noexcept;
+
+
+    // capacity() returns the number of slots in the table.
+    unsigned int capacity() const noexcept;
+
+
+private:
+    // A slot's distance is one more than how far it sits from the slot its
+    // hash maps to, so that a distance of zero marks an empty slot.
+    struct slotInfo
+    {
+        unsigned int hash = 0;
+        unsigned int distance = 0;
+    };
+
+    HashPolicy hasher;
+    slotInfo* info;
+    T* values;
+    unsigned int tableSize;
+    unsigned int tableCapacity;
+
+    // The number of bits that homeIndex() shifts away, leaving as many as
+    // it takes to index the table.
+    unsigned int homeShift;
+
+    SetVersion contents;
+
+    // How many keys containsMany() hashes and prefetches at a time.
+    static constexpr unsigned int LOOKUP_BATCH_SIZE = 32;
+
+    unsigned int homeIndex(unsigned int hash) const noexcept;
+    unsigned int hashOf(const T& element) const;
+    template <typename K>
+    unsigned int hashKey(const K& element) const;
+    template <typename K, typename HashAt>
+    void lookupBatches(const std::vector<K>& keys, std::vector<bool>& found, HashAt hashAt) const;
+    template <typename K>
+    bool find(unsigned int hash, const K& element) const;
+    void insert(unsigned int hash, T element);
+    void rehash(unsigned int newCapacity);
+    void allocate(unsigned int newCapacity);
+    void copyAll(const FlatHashSet& s);
+};
+
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>::FlatHashSet(const HashPolicy& hashPolicy)
+    : hasher{hashPolicy}, info{nullptr}, values{nullptr},
+      tableSize{0}, tableCapacity{0}, homeShift{32}
+{
+    allocate(DEFAULT_CAPACITY);
+}
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>::~FlatHashSet() noexcept
+{
+    delete[] info;
+    delete[] values;
+}
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>::FlatHashSet(const FlatHashSet& s)
+    : hasher{s.hasher}, info{nullptr}, values{nullptr},
+      tableSize{0}, tableCapacity{0}, homeShift{32}
+{
+    copyAll(s);
+}
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>::FlatHashSet(FlatHashSet&& s) noexcept
+    : hasher{s.hasher}, info{nullptr}, values{nullptr},
+      tableSize{0}, tableCapacity{0}, homeShift{32}
+{
+    std::swap(info, s.info);
+    std::swap(values, s.values);
+    std::swap(tableSize, s.tableSize);
+    std::swap(tableCapacity, s.tableCapacity);
+    std::swap(homeShift, s.homeShift);
+}
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>& FlatHashSet<T, HashPolicy>::operator=(const FlatHashSet& s)
+{
+    if (this != &s)
+    {
+        FlatHashSet copy{s};
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+
+template <typename T, typename HashPolicy>
+FlatHashSet<T, HashPolicy>& FlatHashSet<T, HashPolicy>::operator=(FlatHashSet&& s) noexcept
+{
+    std::swap(hasher, s.hasher);
+    std::swap(info, s.info);
+    std::swap(values, s.values);
+    std::swap(tableSize, s.tableSize);
+    std::swap(tableCapacity, s.tableCapacity);
+    std::swap(homeShift, s.homeShift);
+    contents.bump();
+    s.contents.bump();
+    return *this;
+}
+
+
+template <typename T, typename HashPolicy>
+bool FlatHashSet<T, HashPolicy>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename HashPolicy>
+void FlatHashSet<T, HashPolicy>::add(const T& element)
+{
+    unsigned int hash = hashOf(element);
+    if (find(hash, element))
+        return;
+
+    // Keep the load factor at or below 7/8; Robin Hood probing keeps probe
+    // sequences short well past the 0.8 that HashSet uses.  A set that was
+    // moved from has no table and gets a new one of the default size.
+    if ((tableSize + 1) * 8 > tableCapacity * 7)
+        rehash(tableCapacity == 0 ? DEFAULT_CAPACITY : tableCapacity * 2);
+
+    insert(hash, element);
+    tableSize++;
+    contents.bump();
+}
+
+
+template <typename T, typename HashPolicy>
+bool FlatHashSet<T, HashPolicy>::contains(const T& element) const
+{
+    return find(hashOf(element), element);
+}
+
+
+template <typename T, typename HashPolicy>
+unsigned int FlatHashSet<T, HashPolicy>::hashOf(const T& element) const
+{
+    return foldHash(hasher(element));
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+unsigned int FlatHashSet<T, HashPolicy>::hashKey(const K& element) const
+{
+    if constexpr (std::is_same<K, T>::value)
+        return hashOf(element);
+    else if constexpr (std::is_invocable<const HashPolicy&, const K&>::value)
+        return foldHash(hasher(element));
+    else
+    {
+        thread_local T buffer;
+        buffer = element;
+        return hashOf(buffer);
+    }
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+bool FlatHashSet<T, HashPolicy>::find(unsigned int hash, const K& element) const
+{
+    if (tableCapacity == 0)
+        return false;
+
+    unsigned int mask = tableCapacity - 1;
+    unsigned int index = homeIndex(hash);
+
+    // An element can only be further along than a slot whose occupant is
+    // closer to its own home, so the search stops at the first such slot.
+    for (unsigned int distance = 1; distance <= info[index].distance; distance++)
+    {
+        if (info[index].hash == hash && values[index] == element)
+            return true;
+        index = (index + 1) & mask;
+    }
+    return false;
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+bool FlatHashSet<T, HashPolicy>::contains(const K& key) const
+{
+    return find(hashKey(key), key);
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+void FlatHashSet<T, HashPolicy>::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    lookupBatches(keys, found, [&](std::size_t i) { return hashKey(keys[i]); });
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+bool FlatHashSet<T, HashPolicy>::containsHashed(HashValue hash, const K& key) const
+{
+    return find(foldHash(hash), key);
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K>
+void FlatHashSet<T, HashPolicy>::containsManyHashed(
+    const std::vector<K>& keys, const std::vector<HashValue>& hashes,
+    std::vector<bool>& found) const
+{
+    lookupBatches(keys, found, [&](std::size_t i) { return foldHash(hashes[i]); });
+}
+
+
+template <typename T, typename HashPolicy>
+template <typename K, typename HashAt>
+void FlatHashSet<T, HashPolicy>::lookupBatches(const std::vector<K>& keys, std::vector<bool>& found, HashAt hashAt) const
+{
+    found.assign(keys.size(), false);
+    if (tableCapacity == 0)
+        return;
+
+    unsigned int hashes[LOOKUP_BATCH_SIZE];
+    for (std::size_t first = 0; first < keys.size(); first += LOOKUP_BATCH_SIZE)
+    {
+        std::size_t count = std::min<std::size_t>(LOOKUP_BATCH_SIZE, keys.size() - first);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashes[i] = hashAt(first + i);
+            unsigned int index = homeIndex(hashes[i]);
+            prefetch(&info[index]);
+            prefetch(&values[index]);
+        }
+        for (std::size_t i = 0; i < count; i++)
+            found[first+i] = find(hashes[i], keys[first+i]);
+    }
+}
+
+
+template <typename T, typename HashPolicy>
+unsigned int FlatHashSet<T, HashPolicy>::size() const noexcept
+{
+    return tableSize;
+}
+
+
+template <typename T, typename HashPolicy>
+unsigned long long FlatHashSet<T, HashPolicy>::version() const noexcept
+{
+    return contents.get();
+}
+
+
+template <typename T, typename HashPolicy>
+unsigned int FlatHashSet<T, HashPolicy>::capacity() const noexcept
+{
+    return tableCapacity;
+}
+
+
+template <typename T, typename HashPolicy>
+unsigned int FlatHashSet<T, HashPolicy>::homeIndex(unsigned int hash) const noexcept
+{
+    // Fibonacci hashing: multiplying by 2^32 divided by the golden ratio
+    // carries every bit of the hash into the high bits of the product, so
+    // taking those as the index spreads hashes that differ only in their
+    // high bits too.  The low bits of the product would depend only on the
+    // low bits of the hash.
+    return (hash * 2654435769u) >> homeShift;
+}
+
+
+template <typename T, typename HashPolicy>
+void FlatHashSet<T, HashPolicy>::insert(unsigned int hash, T element)
+{
+    unsigned int mask = tableCapacity - 1;
+    unsigned int index = homeIndex(hash);
+    unsigned int distance = 1;
+
+    while (info[index].distance != 0)
+    {
+        // Take the slot from any occupant that is closer to its home than
+        // we are to ours, and carry on inserting the displaced element.
+        if (info[index].distance < distance)
+        {
+            std::swap(info[index].hash, hash);
+            std::swap(info[index].distance, distance);
+            std::swap(values[index], element);
+        }
+        index = (index + 1) & mask;
+        distance++;
+    }
+
+    info[index].hash = hash;
+    info[index].distance = distance;
+    values[index] = std::move(element);
+}
+
+
+template <typename T, typename HashPolicy>
+void FlatHashSet<T, HashPolicy>::rehash(unsigned int newCapacity)
+{
+    STATS_COUNT("FlatHashSet.rehashes");
+    STATS_TIME("FlatHashSet.rehash_ns");
+
+    slotInfo* oldInfo = info;
+    T* oldValues = values;
+    unsigned int oldCapacity = tableCapacity;
+
+    allocate(newCapacity);
+    for (unsigned int i = 0; i < oldCapacity; i++)
+    {
+        if (oldInfo[i].distance != 0)
+            insert(oldInfo[i].hash, std::move(oldValues[i]));
+    }
+
+    delete[] oldInfo;
+    delete[] oldValues;
+}
+
+
+template <typename T, typename HashPolicy>
+void FlatHashSet<T, HashPolicy>::allocate(unsigned int newCapacity)
+{
+    slotInfo* newInfo = new slotInfo[newCapacity];
+    T* newValues = nullptr;
+    try
+    {
+        newValues = new T[newCapacity];
+    }
+    catch (...)
+    {
+        delete[] newInfo;
+        throw;
+    }
+
+    info = newInfo;
+    values = newValues;
+    tableCapacity = newCapacity;
+    homeShift = 32;
+    for (unsigned int c = newCapacity; c > 1; c >>= 1)
+        homeShift--;
+}
+
+
+template <typename T, typename HashPolicy>
+void FlatHashSet<T, HashPolicy>::copyAll(const FlatHashSet& s)
+{
+    allocate(s.tableCapacity);
+    for (unsigned int i = 0; i < tableCapacity; i++)
+    {
+        info[i] = s.info[i];
+        if (s.info[i].distance != 0)
+            values[i] = s.values[i];
+    }
+    tableSize = s.tableSize;
+}
+
+
+
+#endif // FLATHASHSET_HPP
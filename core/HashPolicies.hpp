@@ -0,0 +1,213 @@
+#ifndef HASHPOLICIES_HPP
+#define HASHPOLICIES_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+
+// A hash policy is a type whose const function call operator hashes an
+// element to an integer.  HashSet and FlatHashSet take one as a template
+// parameter rather than calling through a std::function, so that the hash
+// can be inlined into every probe.  A policy that can also be called
+// directly with some other key type, as StringHash can with a
+// std::string_view, lets the sets look up such keys without converting
+// them first.
+
+
+
+// StringHash is a fast 64-bit hash of strings in the style of wyhash: the
+// input is read eight bytes at a time and each pair of words is mixed by
+// one 64x64->128-bit multiplication.  It accepts anything that converts to
+// a std::string_view.
+struct StringHash
+{
+    std::uint64_t operator()(std::string_view s) const noexcept;
+
+private:
+    static constexpr std::uint64_t P0 = 0xa0761d6478bd642full;
+    static constexpr std::uint64_t P1 = 0xe7037ed1a0b428dbull;
+
+    static std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept;
+    static std::uint64_t read8(const char* p) noexcept;
+    static std::uint64_t read4(const char* p) noexcept;
+};
+
+
+
+// PolynomialHash hashes a string as the polynomial s[0]*B^(n-1) + ... +
+// s[n-1] in the base B, modulo 2^64, and then mixes in its length and
+// scrambles the bits.  The polynomial of a string made by replacing,
+// inserting, deleting or swapping letters of another string follows in
+// constant time from the polynomials of the other's prefixes and
+// suffixes, so BasicWordChecker can hash its candidate spellings without
+// reading them, passing the hashes to containsHashed().
+struct PolynomialHash
+{
+    static constexpr std::uint64_t BASE = 0x100000001b3ull;
+
+    std::uint64_t operator()(std::string_view s) const noexcept
+    {
+        return finalize(polynomial(s), s.size());
+    }
+
+    // polynomial() returns the string's polynomial before finalize().
+    static std::uint64_t polynomial(std::string_view s) noexcept
+    {
+        std::uint64_t p = 0;
+        for (char c : s)
+            p = p * BASE + static_cast<unsigned char>(c);
+        return p;
+    }
+
+    // finalize() turns the polynomial of a string of the given length into
+    // its hash.
+    static std::uint64_t finalize(std::uint64_t p, std::size_t length) noexcept
+    {
+        std::uint64_t h = p + length * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 32;
+        h *= 0xd6e8feb86659fd93ull;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+
+
+// FunctionHash adapts any function that takes a const T& and returns an
+// unsigned int, such as those HashSet used to be given, into a hash
+// policy.  It calls through a std::function, so it is the slow path, kept
+// for hash functions that are only known at run time.
+template <typename T>
+struct FunctionHash
+{
+    typedef std::function<unsigned int(const T&)> HashFunction;
+
+    FunctionHash() = default;
+
+    template <typename F>
+    FunctionHash(F f)
+        : function{std::move(f)}
+    {
+    }
+
+    unsigned int operator()(const T& element) const
+    {
+        return function(element);
+    }
+
+    HashFunction function;
+};
+
+
+
+// DefaultHash<T> is the hash policy the sets use when none is given:
+// StringHash for strings and std::hash for everything else.
+template <typename T>
+struct DefaultHash : std::hash<T>
+{
+};
+
+template <>
+struct DefaultHash<std::string> : StringHash
+{
+};
+
+
+
+// foldHash() narrows a policy's hash to the 32 bits that the sets keep,
+// folding the upper half of a 64-bit hash into the lower half so that
+// none of it goes to waste.
+template <typename Hash>
+inline unsigned int foldHash(Hash hash) noexcept
+{
+    if constexpr (sizeof(Hash) > sizeof(unsigned int))
+        return static_cast<unsigned int>(hash ^ (hash >> 32));
+    else
+        return static_cast<unsigned int>(hash);
+}
+
+
+
+inline std::uint64_t StringHash::operator()(std::string_view s) const noexcept
+{
+    const char* p = s.data();
+    std::size_t length = s.size();
+    std::uint64_t seed = P0;
+    std::uint64_t a;
+    std::uint64_t b;
+
+    if (length <= 16)
+    {
+        // Short strings, which are most words, are covered by at most
+        // four overlapping reads with no loop at all.
+        if (length >= 4)
+        {
+            std::size_t middle = (length >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + middle);
+            b = (read4(p + length - 4) << 32) | read4(p + length - 4 - middle);
+        }
+        else if (length > 0)
+        {
+            a = (std::uint64_t{static_cast<unsigned char>(p[0])} << 16)
+                | (std::uint64_t{static_cast<unsigned char>(p[length >> 1])} << 8)
+                | static_cast<unsigned char>(p[length - 1]);
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        std::size_t i = length;
+        for (; i > 16; i -= 16, p += 16)
+            seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+
+    return mix(P1 ^ length, mix(a ^ P1, b ^ seed));
+}
+
+
+inline std::uint64_t StringHash::mix(std::uint64_t a, std::uint64_t b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+    std::uint64_t aHigh = a >> 32, aLow = a & 0xFFFFFFFF;
+    std::uint64_t bHigh = b >> 32, bLow = b & 0xFFFFFFFF;
+    std::uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+    std::uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+    std::uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+    std::uint64_t low = (middle << 32) | (lowLow & 0xFFFFFFFF);
+    std::uint64_t high = highHigh + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+
+inline std::uint64_t StringHash::read8(const char* p) noexcept
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+inline std::uint64_t StringHash::read4(const char* p) noexcept
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+
+
+#endif // HASHPOLICIES_HPP
@@ -2,12 +2,27 @@
 #ifndef HASHSET_HPP
 #define HASHSET_HPP
 
-#include <functional>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Allocators.hpp"
+#include "HashPolicies.hpp"
+#include "Prefetch.hpp"
 #include "Set.hpp"
+#include "SetVersion.hpp"
+#include "Stats.hpp"
 
 
 
-template <typename T>
+// The HashPolicy hashes elements (see HashPolicies.hpp); use
+// FunctionHash<T> to hash with a function chosen at run time.  The
+// Allocator supplies the memory for the nodes and the bucket arrays,
+// rebound to each of their types.  See Allocators.hpp for an arena and a
+// node pool that cut the cost of loading a large dictionary.
+template <typename T, typename HashPolicy = DefaultHash<T>, typename Allocator = std::allocator<T>>
 class HashSet : public Set<T>
 {
 public:
@@ -15,14 +30,20 @@ public:
     // added to it.
     static constexpr unsigned int DEFAULT_CAPACITY = 10;
 
-    // A HashFunction is a function that takes a reference to a const T
-    // and returns an unsigned int.
-    typedef std::function<unsigned int(const T&)> HashFunction;
+    // When the table grows, its elements are migrated into the new array
+    // a few buckets at a time rather than all at once.  This is how many
+    // buckets of the old array each call to add() migrates.
+    static constexpr unsigned int MIGRATE_BUCKETS_PER_ADD = 4;
+
+    // The hash policy, and the type of the hashes it returns.
+    typedef HashPolicy HashPolicyType;
+    typedef decltype(std::declval<const HashPolicy&>()(std::declval<const T&>())) HashValue;
 
 public:
     // Initializes a HashSet to be empty, so that it will use the given
-    // hash function whenever it needs to hash an element.
-    HashSet(HashFunction hashFunction);
+    // hash policy whenever it needs to hash an element and take its
+    // memory from the given allocator.
+    explicit HashSet(const HashPolicy& hashPolicy = HashPolicy(), const Allocator& allocator = Allocator());
 
     // Cleans up the HashSet so that it leaks no memory.
     virtual ~HashSet() noexcept;
@@ -31,7 +52,8 @@ public:
     HashSet(const HashSet& s);
 
     // Initializes a new HashSet whose contents are moved from an
-    // expiring one.
+    // expiring one.  The expiring one is left empty, with no array at all
+    // until something is added to it.
     HashSet(HashSet&& s) noexcept;
 
     // Assigns an existing HashSet into another.
@@ -56,312 +78,677 @@ public:
     virtual bool contains(const T& element) const override;
 
 
+    // This version of contains() accepts any key that can be compared with
+    // a T, such as a std::string_view for a HashSet<std::string>.  When the
+    // hash policy can hash the key itself, it is hashed directly; otherwise
+    // it is assigned to a per-thread T that is reused from one call to the
+    // next, so repeated lookups do not allocate.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.  The keys are hashed and
+    // their buckets prefetched a batch at a time before any of them is
+    // compared, so the cache misses of a batch overlap instead of being
+    // paid one after another.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // containsHashed() is contains() for a key whose hash is already known,
+    // as it is when it was derived from the hash of a similar key.  The
+    // hash must be the one the set's hash policy returns for the key.
+    template <typename K>
+    bool containsHashed(HashValue hash, const K& key) const;
+
+
+    // containsManyHashed() is containsMany() for keys whose hashes are
+    // already known; hashes[i] must be the hash of keys[i].
+    template <typename K>
+    void containsManyHashed(
+        const std::vector<K>& keys, const std::vector<HashValue>& hashes,
+        std::vector<bool>& found) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
 
+    // version() returns a number that changes whenever the set's elements
+    // might have (see SetVersion.hpp).
+    unsigned long long version() const noexcept;
+
+
+    // reserve() makes room for at least n elements, so that adding them
+    // will not trigger any further resizing.
+    void reserve(unsigned int n);
+
+
     // elementsAtIndex() returns the number of elements that hashed to a
     // particular index in the array.  If the index is out of the boundaries
     // of the array, this function returns 0.
     unsigned int elementsAtIndex(unsigned int index) const;
 
 
+    // chainLengths() returns the distribution of elementsAtIndex() over
+    // the whole array: entry n is the number of indexes that n elements
+    // hashed to.  In a build with statistics, it is also recorded in the
+    // HashSet.chain_length histogram every time the array grows, when the
+    // array is at its fullest.
+    std::vector<unsigned int> chainLengths() const;
+
+
     // isElementAtIndex() returns true if the given element hashed to a
     // particular index in the array, false otherwise.  If the index is
     // out of the boundaries of the array, this functions returns 0.
     bool isElementAtIndex(const T& element, unsigned int index) const;
 
 
+    // allocator() returns a copy of the allocator that the set's nodes
+    // come from, through which its AllocationCounters can be read when
+    // it has any.
+    Allocator allocator() const;
+
+
 private:
-	HashFunction hashFunction;
+    HashPolicy hasher;
     struct hashNode
     {
-        int key;
+        unsigned int key;
         T value;
         hashNode* next = nullptr;
     };
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<hashNode> NodeAllocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<hashNode*> ArrayAllocator;
+    typedef std::allocator_traits<NodeAllocator> NodeTraits;
+    typedef std::allocator_traits<ArrayAllocator> ArrayTraits;
+
+    // When the allocator frees everything at once and the elements have
+    // no destructor to run, destroying the set skips walking its chains.
+    static constexpr bool SKIP_NODE_TEARDOWN =
+        releasesInBulk<Allocator>::value && std::is_trivially_destructible<T>::value;
+
+    NodeAllocator nodeAllocator;
+    ArrayAllocator arrayAllocator;
+
+    // While a resize is in progress, oldArr holds the previous array and
+    // every bucket of it below migrateIndex has already been moved into
+    // hashArr.  Lookups consult both arrays until the migration finishes.
     hashNode** hashArr;
-    int tableSize;
-    int capacity;
-	void copyAll(const HashSet& s);
-    void resize();
+    hashNode** oldArr;
+    unsigned int tableSize;
+    unsigned int capacity;
+    unsigned int oldCapacity;
+    unsigned int migrateIndex;
+    SetVersion contents;
+
+    // How many keys containsMany() hashes and prefetches at a time.
+    static constexpr unsigned int LOOKUP_BATCH_SIZE = 32;
+
+    unsigned int hashOf(const T& element) const;
+    template <typename K>
+    unsigned int hashKey(const K& element) const;
+    template <typename K, typename HashAt>
+    void lookupBatches(const std::vector<K>& keys, std::vector<bool>& found, HashAt hashAt) const;
+    template <typename K>
+    bool find(const K& element, unsigned int key) const;
+    void insert(const T& element, unsigned int key);
+    void copyAll(const HashSet& s);
+    void resize(unsigned int newCapacity);
+    void recordChainLengths() const;
+    void migrate(unsigned int buckets);
+    void finishMigration();
     hashNode* createNode();
-	void deleteAll(hashNode** arr);
+    void destroyNode(hashNode* node) noexcept;
+    hashNode** createArray(unsigned int size);
+    void destroyArray(hashNode** arr, unsigned int size) noexcept;
+    void deleteAll(hashNode** arr, unsigned int size);
 };
 
 
 
-template <typename T>
-HashSet<T>::HashSet(HashFunction hashFunction)
-    : hashFunction{hashFunction}
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>::HashSet(const HashPolicy& hashPolicy, const Allocator& allocator)
+    : hasher{hashPolicy}, nodeAllocator{allocator},
+      arrayAllocator{allocator}, hashArr{nullptr}, oldArr{nullptr},
+      tableSize{0}, capacity{DEFAULT_CAPACITY}, oldCapacity{0},
+      migrateIndex{0}
+{
+    hashArr = createArray(capacity);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>::~HashSet() noexcept
+{
+    deleteAll(hashArr, capacity);
+    deleteAll(oldArr, oldCapacity);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>::HashSet(const HashSet& s)
+    : hasher{s.hasher},
+      nodeAllocator{NodeTraits::select_on_container_copy_construction(s.nodeAllocator)},
+      arrayAllocator{ArrayTraits::select_on_container_copy_construction(s.arrayAllocator)},
+      hashArr{nullptr}, oldArr{nullptr},
+      tableSize{0}, capacity{0}, oldCapacity{0}, migrateIndex{0}
 {
-	capacity = DEFAULT_CAPACITY;
-	tableSize = 0;
     try
     {
-        hashArr = new hashNode*[capacity];
-    }catch(...)
+        copyAll(s);
+    }
+    catch (...)
     {
-        delete hashArr;
+        deleteAll(hashArr, capacity);
+        deleteAll(oldArr, oldCapacity);
         throw;
     }
-    for (int i = 0; i < capacity; i++)
-        hashArr[i] = nullptr;
 }
 
 
-template <typename T>
-HashSet<T>::~HashSet() noexcept
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>::HashSet(HashSet&& s) noexcept
+    : hasher{s.hasher}, nodeAllocator{s.nodeAllocator},
+      arrayAllocator{s.arrayAllocator}, hashArr{nullptr}, oldArr{nullptr},
+      tableSize{0}, capacity{0}, oldCapacity{0}, migrateIndex{0}
 {
-	deleteAll(hashArr);
+    *this = std::move(s);
 }
 
 
-template <typename T>
-HashSet<T>::HashSet(const HashSet& s)
-    : hashFunction{nullptr}
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>& HashSet<T, HashPolicy, Allocator>::operator=(const HashSet& s)
 {
-	capacity = s.capacity;
-	tableSize = s.tableSize;
-	copyAll(s);
+    if (this != &s)
+    {
+        HashSet copy{s};
+        *this = std::move(copy);
+    }
+    return *this;
 }
 
 
-template <typename T>
-HashSet<T>::HashSet(HashSet&& s) noexcept
-    : hashFunction{nullptr}
+template <typename T, typename HashPolicy, typename Allocator>
+HashSet<T, HashPolicy, Allocator>& HashSet<T, HashPolicy, Allocator>::operator=(HashSet&& s) noexcept
 {
-	std::swap(hashArr, s.hashArr);
+    // The nodes go wherever their allocator goes, so the allocators are
+    // swapped along with the arrays, and the hash policy along with the
+    // hashes it made.
+    std::swap(hasher, s.hasher);
+    std::swap(nodeAllocator, s.nodeAllocator);
+    std::swap(arrayAllocator, s.arrayAllocator);
+    std::swap(hashArr, s.hashArr);
+    std::swap(oldArr, s.oldArr);
+    std::swap(tableSize, s.tableSize);
+    std::swap(capacity, s.capacity);
+    std::swap(oldCapacity, s.oldCapacity);
+    std::swap(migrateIndex, s.migrateIndex);
+    contents.bump();
+    s.contents.bump();
+    return *this;
 }
 
 
-template <typename T>
-HashSet<T>& HashSet<T>::operator=(const HashSet& s)
+template <typename T, typename HashPolicy, typename Allocator>
+bool HashSet<T, HashPolicy, Allocator>::isImplemented() const noexcept
 {
-	capacity = s.capacity;
-    tableSize = s.tableSize;
-    copyAll(s);
-    return *this;
+    return true;
 }
 
 
-template <typename T>
-HashSet<T>& HashSet<T>::operator=(HashSet&& s) noexcept
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::add(const T& element)
 {
-	std::swap(hashArr, s.hashArr);
-    return *this;
+    if (capacity == 0)
+    {
+        hashArr = createArray(DEFAULT_CAPACITY);
+        capacity = DEFAULT_CAPACITY;
+    }
+
+    if (oldArr != nullptr)
+        migrate(MIGRATE_BUCKETS_PER_ADD);
+
+    unsigned int key = hashOf(element);
+    if (find(element, key))
+        return;
+    insert(element, key);
+    tableSize++;
+    contents.bump();
+
+    // Starting a resize only allocates the new array; the elements follow
+    // over the next few calls to add().  MIGRATE_BUCKETS_PER_ADD is large
+    // enough that a migration always finishes before the doubled array
+    // reaches the load factor again.
+    if (oldArr == nullptr && double(tableSize)/capacity > 0.8)
+        resize(capacity*2);
 }
 
 
-template <typename T>
-bool HashSet<T>::isImplemented() const noexcept
+template <typename T, typename HashPolicy, typename Allocator>
+bool HashSet<T, HashPolicy, Allocator>::contains(const T& element) const
 {
-    return true;
+    return find(element, hashOf(element));
 }
 
 
-template <typename T>
-void HashSet<T>::add(const T& element)
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+bool HashSet<T, HashPolicy, Allocator>::contains(const K& key) const
 {
-	int key = hashFunction(element);
-	int index = key%capacity;
-    if(isElementAtIndex(element,index))
+    return find(key, hashKey(key));
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+void HashSet<T, HashPolicy, Allocator>::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    lookupBatches(keys, found, [&](std::size_t i) { return hashKey(keys[i]); });
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+bool HashSet<T, HashPolicy, Allocator>::containsHashed(HashValue hash, const K& key) const
+{
+    return find(key, foldHash(hash));
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+void HashSet<T, HashPolicy, Allocator>::containsManyHashed(
+    const std::vector<K>& keys, const std::vector<HashValue>& hashes,
+    std::vector<bool>& found) const
+{
+    lookupBatches(keys, found, [&](std::size_t i) { return foldHash(hashes[i]); });
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K, typename HashAt>
+void HashSet<T, HashPolicy, Allocator>::lookupBatches(const std::vector<K>& keys, std::vector<bool>& found, HashAt hashAt) const
+{
+    found.assign(keys.size(), false);
+    if (capacity == 0)
         return;
-    if (hashArr[index] != nullptr)
+
+    unsigned int hashes[LOOKUP_BATCH_SIZE];
+    for (std::size_t first = 0; first < keys.size(); first += LOOKUP_BATCH_SIZE)
     {
-        hashNode* curr = hashArr[index];
-        while(curr->next != nullptr)
-        { 
-            curr = curr->next;
+        std::size_t count = std::min<std::size_t>(LOOKUP_BATCH_SIZE, keys.size() - first);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashes[i] = hashAt(first + i);
+            prefetch(&hashArr[hashes[i]%capacity]);
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashNode* head = hashArr[hashes[i]%capacity];
+            if (head != nullptr)
+                prefetch(head);
         }
-		curr->next = createNode();
-		curr->next->value = element;
-		curr->next->key = key;
-		tableSize++;
+        for (std::size_t i = 0; i < count; i++)
+            found[first+i] = find(keys[first+i], hashes[i]);
     }
-	else
-	{
-		hashArr[index] = createNode();
-		hashArr[index]->value = element;
-		hashArr[index]->key = key;
-		tableSize++;
-	}
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+unsigned int HashSet<T, HashPolicy, Allocator>::size() const noexcept
+{
+    return tableSize;
+}
 
-    if(double(tableSize)/capacity > 0.8)
-        resize();
+
+template <typename T, typename HashPolicy, typename Allocator>
+unsigned long long HashSet<T, HashPolicy, Allocator>::version() const noexcept
+{
+    return contents.get();
 }
 
 
-template <typename T>
-bool HashSet<T>::contains(const T& element) const
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::reserve(unsigned int n)
 {
-    int key = hashFunction(element);
-    int index = key%capacity;
-    hashNode* curr = hashArr[index];
-    while (curr != nullptr)
+    // Doubling stops before the capacity would overflow, however many
+    // elements are asked for.
+    unsigned int needed = std::max(capacity, DEFAULT_CAPACITY);
+    while (double(n)/needed > 0.8 && needed <= std::numeric_limits<unsigned int>::max() / 2)
+        needed *= 2;
+    if (needed == capacity)
+        return;
+
+    // A set that was moved from has no array to migrate from.
+    if (capacity == 0)
     {
-        if (curr->value == element)
-            return true;
-        curr = curr->next;
+        hashArr = createArray(needed);
+        capacity = needed;
+        return;
     }
-    return false;
+
+    finishMigration();
+    resize(needed);
+    finishMigration();
 }
 
 
-template <typename T>
-unsigned int HashSet<T>::size() const noexcept
+template <typename T, typename HashPolicy, typename Allocator>
+unsigned int HashSet<T, HashPolicy, Allocator>::elementsAtIndex(unsigned int index) const
 {
-    return tableSize;
+    if (index >= capacity)
+        return 0;
+
+    unsigned int count = 0;
+    for (hashNode* curr = hashArr[index]; curr != nullptr; curr = curr->next)
+        count++;
+
+    // Elements still waiting in the old array count towards the index
+    // they will occupy once they have been migrated.
+    if (oldArr != nullptr && index%oldCapacity >= migrateIndex)
+    {
+        for (hashNode* curr = oldArr[index%oldCapacity]; curr != nullptr; curr = curr->next)
+        {
+            if (curr->key%capacity == index)
+                count++;
+        }
+    }
+    return count;
 }
 
 
-template <typename T>
-unsigned int HashSet<T>::elementsAtIndex(unsigned int index) const
+template <typename T, typename HashPolicy, typename Allocator>
+std::vector<unsigned int> HashSet<T, HashPolicy, Allocator>::chainLengths() const
 {
-	int count = 0;
-    hashNode* curr = hashArr[index];
-    while (curr != nullptr)
+    std::vector<unsigned int> lengths;
+    for (unsigned int i = 0; i < capacity; i++)
     {
-		count++;		
-        curr = curr->next;
+        unsigned int length = elementsAtIndex(i);
+        if (length >= lengths.size())
+            lengths.resize(length + 1);
+        lengths[length]++;
     }
-	return count;
+    return lengths;
 }
 
 
-template <typename T>
-bool HashSet<T>::isElementAtIndex(const T& element, unsigned int index) const
+template <typename T, typename HashPolicy, typename Allocator>
+bool HashSet<T, HashPolicy, Allocator>::isElementAtIndex(const T& element, unsigned int index) const
 {
-    hashNode* curr = hashArr[index];
-	while (curr != nullptr)
-	{
-		if (curr->value == element)
-			return true;
-		curr = curr->next;
-	}
-	return false;
+    if (index >= capacity)
+        return false;
+    unsigned int key = hashOf(element);
+    return key%capacity == index && find(element, key);
 }
 
 
-template <typename T>
-typename HashSet<T>::hashNode* HashSet<T>::createNode()
+template <typename T, typename HashPolicy, typename Allocator>
+Allocator HashSet<T, HashPolicy, Allocator>::allocator() const
 {
-    hashNode* new_node = nullptr;
+    return Allocator(nodeAllocator);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+unsigned int HashSet<T, HashPolicy, Allocator>::hashOf(const T& element) const
+{
+    return foldHash(hasher(element));
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+unsigned int HashSet<T, HashPolicy, Allocator>::hashKey(const K& element) const
+{
+    if constexpr (std::is_same<K, T>::value)
+        return hashOf(element);
+    else if constexpr (std::is_invocable<const HashPolicy&, const K&>::value)
+        return foldHash(hasher(element));
+    else
+    {
+        thread_local T buffer;
+        buffer = element;
+        return hashOf(buffer);
+    }
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+template <typename K>
+bool HashSet<T, HashPolicy, Allocator>::find(const K& element, unsigned int key) const
+{
+    if (capacity == 0)
+        return false;
+
+    for (hashNode* curr = hashArr[key%capacity]; curr != nullptr; curr = curr->next)
+    {
+        if (curr->key == key && curr->value == element)
+            return true;
+    }
+
+    if (oldArr != nullptr)
+    {
+        unsigned int oldIndex = key%oldCapacity;
+        if (oldIndex >= migrateIndex)
+        {
+            for (hashNode* curr = oldArr[oldIndex]; curr != nullptr; curr = curr->next)
+            {
+                if (curr->key == key && curr->value == element)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::insert(const T& element, unsigned int key)
+{
+    // Chains are unordered, so new nodes go at the head rather than
+    // walking to the tail.
+    hashNode* node = createNode();
     try
     {
-        new_node = new hashNode;
+        node->value = element;
     }
-    catch(...)
+    catch (...)
     {
-        delete new_node;
+        destroyNode(node);
         throw;
     }
-    return new_node;
+    node->key = key;
+    node->next = hashArr[key%capacity];
+    hashArr[key%capacity] = node;
 }
 
 
-template <typename T>
-void HashSet<T>::resize()
+template <typename T, typename HashPolicy, typename Allocator>
+typename HashSet<T, HashPolicy, Allocator>::hashNode* HashSet<T, HashPolicy, Allocator>::createNode()
 {
-	int newCapacity = capacity*2;
-   	hashNode** newArr;
+    hashNode* node = NodeTraits::allocate(nodeAllocator, 1);
     try
     {
-        newArr = new hashNode*[newCapacity];
-    }catch(...)
+        NodeTraits::construct(nodeAllocator, node);
+    }
+    catch (...)
     {
-        delete hashArr;
+        NodeTraits::deallocate(nodeAllocator, node, 1);
         throw;
     }
-	for (int i = 0; i < newCapacity; i++)
-		newArr[i] = nullptr;
-	
-	for (int i = 0; i < capacity; i++)
+    return node;
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::destroyNode(hashNode* node) noexcept
+{
+    NodeTraits::destroy(nodeAllocator, node);
+    NodeTraits::deallocate(nodeAllocator, node, 1);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+typename HashSet<T, HashPolicy, Allocator>::hashNode** HashSet<T, HashPolicy, Allocator>::createArray(unsigned int size)
+{
+    hashNode** arr = ArrayTraits::allocate(arrayAllocator, size);
+    for (unsigned int i = 0; i < size; i++)
+        arr[i] = nullptr;
+    return arr;
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::destroyArray(hashNode** arr, unsigned int size) noexcept
+{
+    ArrayTraits::deallocate(arrayAllocator, arr, size);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::resize(unsigned int newCapacity)
+{
+    STATS_COUNT("HashSet.resizes");
+    if constexpr (Stats::ENABLED)
+        recordChainLengths();
+
+    oldArr = hashArr;
+    oldCapacity = capacity;
+    migrateIndex = 0;
+    try
     {
-		if(hashArr[i] != nullptr)
-		{
-			hashNode* originCurr = hashArr[i];
-			while(originCurr != nullptr)
-			{
-				int newIndex = (originCurr->key)%newCapacity;
-				if (newArr[newIndex] != nullptr)
-				{
-					hashNode* curr = newArr[newIndex];
-					while(curr->next != nullptr)
-					{
-						curr = curr->next;
-					}
-					curr->next = createNode();
-					curr->next->value = originCurr->value;
-					curr->next->key = originCurr->key;
-				}
-				else
-				{
-					newArr[newIndex] = createNode();
-			        newArr[newIndex]->value = originCurr->value;
-                    newArr[newIndex]->key = originCurr->key;
-				}
-                originCurr = originCurr->next;
-            }
-	    }
-	}
-	deleteAll(hashArr);
-    hashArr = newArr;
+        hashArr = createArray(newCapacity);
+    }
+    catch (...)
+    {
+        hashArr = oldArr;
+        oldArr = nullptr;
+        oldCapacity = 0;
+        throw;
+    }
     capacity = newCapacity;
 }
 
 
-template <typename T>
-void HashSet<T>::copyAll(const HashSet& s)
-{
-	try
-	{
-		hashArr = new hashNode*[capacity];
-	}catch(...)
-	{
-		delete hashArr;
-		throw;
-	}
-	
-	for (int i = 0; i < capacity; i++)
-	{
-		hashNode* originCurr = s.hashArr[i];
-		hashNode* copyCurr = hashArr[i];
-		while(originCurr != nullptr)
-		{
-			try
-			{
-				copyCurr = new hashNode;
-			}
-			catch(...)
-			{
-				delete hashArr[i];
-				throw;
-			}
-			copyCurr->value = originCurr->value;
-			copyCurr->key = originCurr->key;
-			copyCurr = copyCurr->next;
-			originCurr = originCurr->next;
-		}
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::recordChainLengths() const
+{
+    static Stats::Histogram& histogram = Stats::histogram("HashSet.chain_length");
+
+    std::vector<unsigned int> lengths = chainLengths();
+    for (std::size_t length = 0; length < lengths.size(); length++)
+        histogram.record(length, lengths[length]);
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::migrate(unsigned int buckets)
+{
+    STATS_TIME("HashSet.migrate_ns");
+
+    // Migrating relinks the existing nodes into the new array, so it
+    // neither allocates nor copies any elements.
+    for (; buckets > 0 && migrateIndex < oldCapacity; buckets--, migrateIndex++)
+    {
+        hashNode* curr = oldArr[migrateIndex];
+        while (curr != nullptr)
+        {
+            hashNode* next = curr->next;
+            curr->next = hashArr[curr->key%capacity];
+            hashArr[curr->key%capacity] = curr;
+            curr = next;
+        }
+        oldArr[migrateIndex] = nullptr;
+    }
+
+    if (migrateIndex == oldCapacity)
+    {
+        destroyArray(oldArr, oldCapacity);
+        oldArr = nullptr;
+        oldCapacity = 0;
+        migrateIndex = 0;
     }
 }
 
-template <typename T>
-void HashSet<T>::deleteAll(hashNode** arr)
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::finishMigration()
 {
-	for (int i = 0; i < capacity; i++)
-	{
-		hashNode* curr = arr[i];
-		while (curr != nullptr)
-		{
-			hashNode* temp = curr;
-			curr = curr->next;
-			delete temp;
-		}
-	}
+    if (oldArr != nullptr)
+        migrate(oldCapacity);
 }
 
 
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::copyAll(const HashSet& s)
+{
+    // Copies preserve each node's bucket, so a migration in progress in s
+    // carries on in the copy from the same point.  A copy of a set that
+    // was moved from has no array either.
+    if (s.capacity == 0)
+        return;
 
-#endif // HASHSET_HPP
+    hashArr = createArray(s.capacity);
+    capacity = s.capacity;
+    if (s.oldArr != nullptr)
+    {
+        oldArr = createArray(s.oldCapacity);
+        oldCapacity = s.oldCapacity;
+        migrateIndex = s.migrateIndex;
+    }
 
+    for (unsigned int i = 0; i < capacity; i++)
+    {
+        for (hashNode* curr = s.hashArr[i]; curr != nullptr; curr = curr->next)
+        {
+            hashNode* node = createNode();
+            node->key = curr->key;
+            node->next = hashArr[i];
+            hashArr[i] = node;
+            node->value = curr->value;
+        }
+    }
+    for (unsigned int i = migrateIndex; i < oldCapacity; i++)
+    {
+        for (hashNode* curr = s.oldArr[i]; curr != nullptr; curr = curr->next)
+        {
+            hashNode* node = createNode();
+            node->key = curr->key;
+            node->next = oldArr[i];
+            oldArr[i] = node;
+            node->value = curr->value;
+        }
+    }
+    tableSize = s.tableSize;
+}
+
+
+template <typename T, typename HashPolicy, typename Allocator>
+void HashSet<T, HashPolicy, Allocator>::deleteAll(hashNode** arr, unsigned int size)
+{
+    if (arr == nullptr)
+        return;
+
+    if constexpr (!SKIP_NODE_TEARDOWN)
+    {
+        for (unsigned int i = 0; i < size; i++)
+        {
+            hashNode* curr = arr[i];
+            while (curr != nullptr)
+            {
+                hashNode* temp = curr;
+                curr = curr->next;
+                destroyNode(temp);
+            }
+        }
+    }
+    destroyArray(arr, size);
+}
+
+
+
+#endif // HASHSET_HPP
@@ -0,0 +1,116 @@
+#include "MappedSet.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedSet::MappedSet(const std::string& path)
+    : mapping{nullptr}, mappingSize{0}, header{nullptr}, slots{nullptr}, pool{nullptr}
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw DictionaryFileException{"could not open dictionary: " + path};
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(DictionaryFormat::Header)))
+    {
+        close(fd);
+        throw DictionaryFileException{"not a compiled dictionary: " + path};
+    }
+
+    mappingSize = status.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        throw DictionaryFileException{"could not map dictionary: " + path};
+
+    const char* base = static_cast<const char*>(mapping);
+    header = reinterpret_cast<const DictionaryFormat::Header*>(base);
+
+    // The header is checked once here.  Slots are only checked as
+    // lookups reach them, since checking them all would make opening the
+    // file cost time in proportion to its size.
+    bool valid =
+        std::memcmp(header->magic, DictionaryFormat::MAGIC, sizeof(header->magic)) == 0
+        && header->version == DictionaryFormat::VERSION
+        && header->byteOrder == DictionaryFormat::ENDIAN_MARK
+        && header->fileSize == mappingSize
+        && header->slotCount != 0
+        && (header->slotCount & (header->slotCount - 1)) == 0
+        && header->wordCount < header->slotCount
+        && header->slotsOffset >= sizeof(DictionaryFormat::Header)
+        && header->slotsOffset % alignof(DictionaryFormat::Slot) == 0
+        && header->slotsOffset + std::uint64_t{header->slotCount} * sizeof(DictionaryFormat::Slot) <= header->poolOffset
+        && header->poolOffset + header->poolSize <= mappingSize;
+
+    if (!valid)
+    {
+        munmap(mapping, mappingSize);
+        throw DictionaryFileException{"not a compiled dictionary: " + path};
+    }
+
+    slots = reinterpret_cast<const DictionaryFormat::Slot*>(base + header->slotsOffset);
+    pool = base + header->poolOffset;
+    madvise(mapping, mappingSize, MADV_RANDOM);
+}
+
+
+MappedSet::~MappedSet() noexcept
+{
+    munmap(mapping, mappingSize);
+}
+
+
+bool MappedSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void MappedSet::add(const std::string&)
+{
+    throw DictionaryFileException{"a mapped dictionary cannot be modified"};
+}
+
+
+bool MappedSet::contains(const std::string& element) const
+{
+    return find(element, DictionaryFormat::hash(element));
+}
+
+
+unsigned int MappedSet::size() const noexcept
+{
+    return header->wordCount;
+}
+
+
+unsigned long long MappedSet::version() const noexcept
+{
+    return contents.get();
+}
+
+
+bool MappedSet::find(std::string_view word, std::uint32_t hash) const
+{
+    // A file written by DictionaryCompiler always has an empty slot, but
+    // one that was damaged or written by something else might not, so a
+    // lookup gives up once it has probed every slot.
+    std::uint32_t mask = header->slotCount - 1;
+    std::uint32_t index = hash & mask;
+    for (std::uint32_t probes = 0;
+         probes < header->slotCount && slots[index].offset != DictionaryFormat::EMPTY;
+         probes++, index = (index + 1) & mask)
+    {
+        if (slots[index].hash == hash
+            && slots[index].length == word.size()
+            && std::uint64_t{slots[index].offset} + slots[index].length <= header->poolSize
+            && std::memcmp(pool + slots[index].offset, word.data(), word.size()) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,118 @@
+#ifndef MAPPEDSET_HPP
+#define MAPPEDSET_HPP
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DictionaryFormat.hpp"
+#include "Prefetch.hpp"
+#include "Set.hpp"
+#include "SetVersion.hpp"
+
+
+
+// A MappedSet is a read-only Set of strings served straight out of a
+// compiled dictionary file (see DictionaryCompiler) that is memory-mapped
+// rather than read.  Opening one costs the same however many words the
+// file holds, and lookups are answered from the operating system's page
+// cache, which every process using the same file shares.
+class MappedSet : public Set<std::string>
+{
+public:
+    // Maps the compiled dictionary at the given path.  A
+    // DictionaryFileException is thrown if it cannot be opened or is not
+    // a compiled dictionary this version understands.
+    MappedSet(const std::string& path);
+
+    // Unmaps the dictionary.
+    virtual ~MappedSet() noexcept;
+
+    MappedSet(const MappedSet& s) = delete;
+    MappedSet& operator=(const MappedSet& s) = delete;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // A MappedSet cannot be modified, so add() always throws a
+    // DictionaryFileException.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // This version of contains() accepts anything that converts to a
+    // std::string_view, without first converting it to a std::string.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.  The keys' slots are
+    // prefetched a batch at a time before any of them is compared.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // version() returns a number that is different for every MappedSet
+    // (see SetVersion.hpp).  A MappedSet never changes, but a file
+    // compiled again and mapped anew is a different set.
+    unsigned long long version() const noexcept;
+
+
+private:
+    // How many keys containsMany() hashes and prefetches at a time.
+    static constexpr unsigned int LOOKUP_BATCH_SIZE = 32;
+
+    void* mapping;
+    std::size_t mappingSize;
+    const DictionaryFormat::Header* header;
+    const DictionaryFormat::Slot* slots;
+    const char* pool;
+    SetVersion contents;
+
+    bool find(std::string_view word, std::uint32_t hash) const;
+};
+
+
+
+template <typename K>
+bool MappedSet::contains(const K& key) const
+{
+    std::string_view word{key};
+    return find(word, DictionaryFormat::hash(word));
+}
+
+
+template <typename K>
+void MappedSet::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    found.assign(keys.size(), false);
+
+    std::uint32_t hashes[LOOKUP_BATCH_SIZE];
+    std::uint32_t mask = header->slotCount - 1;
+    for (std::size_t first = 0; first < keys.size(); first += LOOKUP_BATCH_SIZE)
+    {
+        std::size_t count = std::min<std::size_t>(LOOKUP_BATCH_SIZE, keys.size() - first);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashes[i] = DictionaryFormat::hash(std::string_view{keys[first+i]});
+            prefetch(&slots[hashes[i] & mask]);
+        }
+        for (std::size_t i = 0; i < count; i++)
+            found[first+i] = find(std::string_view{keys[first+i]}, hashes[i]);
+    }
+}
+
+
+
+#endif // MAPPEDSET_HPP
@@ -0,0 +1,149 @@
+#include "PooledStringSet.hpp"
+#include <cstring>
+#include <utility>
+#include "Stats.hpp"
+
+
+PooledStringSet::PooledStringSet()
+    : slots(DEFAULT_CAPACITY), count{0}
+{
+}
+
+
+PooledStringSet::PooledStringSet(PooledStringSet&& s) noexcept
+    : pool{std::move(s.pool)}, slots{std::move(s.slots)}, count{s.count}
+{
+    s.pool.clear();
+    s.slots.clear();
+    s.count = 0;
+    s.contents.bump();
+}
+
+
+PooledStringSet& PooledStringSet::operator=(PooledStringSet&& s) noexcept
+{
+    std::swap(pool, s.pool);
+    std::swap(slots, s.slots);
+    std::swap(count, s.count);
+    contents.bump();
+    s.contents.bump();
+    return *this;
+}
+
+
+bool PooledStringSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void PooledStringSet::add(const std::string& element)
+{
+    std::uint32_t hash = DictionaryFormat::hash(element);
+    if (find(element, hash))
+        return;
+
+    // The table is kept at most three quarters full, so that probe
+    // sequences stay short without open addressing's usual half-empty
+    // table; at 12 bytes a slot the empty ones cost little.  A set that
+    // was moved from has no table and gets a new one of the default size.
+    if (4 * (count + 1) > 3 * slots.size())
+        rehash(slots.empty() ? DEFAULT_CAPACITY : slots.size() * 2);
+
+    Slot slot;
+    slot.hash = hash;
+    slot.offset = pool.size();
+    slot.length = element.size();
+    pool.append(element);
+    place(slot);
+    count++;
+    contents.bump();
+}
+
+
+bool PooledStringSet::contains(const std::string& element) const
+{
+    return find(element, DictionaryFormat::hash(element));
+}
+
+
+unsigned int PooledStringSet::size() const noexcept
+{
+    return count;
+}
+
+
+unsigned long long PooledStringSet::version() const noexcept
+{
+    return contents.get();
+}
+
+
+void PooledStringSet::reserve(unsigned int n, std::size_t characters)
+{
+    pool.reserve(characters);
+
+    unsigned int needed = std::max<unsigned int>(slots.size(), DEFAULT_CAPACITY);
+    while (4 * std::uint64_t{n} > 3 * std::uint64_t{needed})
+        needed *= 2;
+    if (needed != slots.size())
+        rehash(needed);
+}
+
+
+void PooledStringSet::shrinkToFit()
+{
+    pool.shrink_to_fit();
+}
+
+
+std::size_t PooledStringSet::memoryUsage() const noexcept
+{
+    return sizeof(*this) + pool.capacity() + slots.capacity() * sizeof(Slot);
+}
+
+
+bool PooledStringSet::find(std::string_view word, std::uint32_t hash) const
+{
+    if (slots.empty())
+        return false;
+
+    std::uint32_t mask = slots.size() - 1;
+    for (std::uint32_t index = hash & mask; slots[index].offset != EMPTY; index = (index + 1) & mask)
+    {
+        if (slots[index].hash == hash
+            && slots[index].length == word.size()
+            && std::memcmp(pool.data() + slots[index].offset, word.data(), word.size()) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void PooledStringSet::place(const Slot& slot)
+{
+    std::uint32_t mask = slots.size() - 1;
+    std::uint32_t index = slot.hash & mask;
+    while (slots[index].offset != EMPTY)
+        index = (index + 1) & mask;
+    slots[index] = slot;
+}
+
+
+void PooledStringSet::rehash(unsigned int newCapacity)
+{
+    STATS_COUNT("PooledStringSet.rehashes");
+    STATS_TIME("PooledStringSet.rehash_ns");
+
+    // Only the slots move; the text stays where it is in the pool, so
+    // growing the table copies no strings.
+    std::vector<Slot> old(newCapacity);
+    old.swap(slots);
+    for (const Slot& slot : old)
+    {
+        if (slot.offset != EMPTY)
+            place(slot);
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef POOLEDSTRINGSET_HPP
+#define POOLEDSTRINGSET_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DictionaryFormat.hpp"
+#include "Prefetch.hpp"
+#include "Set.hpp"
+#include "SetVersion.hpp"
+
+
+
+// A PooledStringSet is a Set of strings that keeps the text of all of its
+// elements back to back in one contiguous pool of characters.  Its hash
+// table holds only each element's hash, offset and length, 12 bytes in
+// all, rather than a std::string and the node around it, so a large word
+// list takes little more memory than its text and many more slots fit in
+// each cache line.  Lookups compare keys against the pool directly.
+class PooledStringSet : public Set<std::string>
+{
+public:
+    // The default capacity of the table before anything has been added to
+    // it.  Capacities are always powers of two.
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+
+public:
+    // Initializes a PooledStringSet to be empty.
+    PooledStringSet();
+
+    PooledStringSet(const PooledStringSet& s) = default;
+    PooledStringSet& operator=(const PooledStringSet& s) = default;
+
+    // Initializes a new PooledStringSet whose contents are moved from an
+    // expiring one.  The expiring one is left empty, with no table at all
+    // until something is added to it.
+    PooledStringSet(PooledStringSet&& s) noexcept;
+
+    // Assigns an expiring PooledStringSet into another.
+    PooledStringSet& operator=(PooledStringSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // This version of contains() accepts anything that converts to a
+    // std::string_view, without first converting it to a std::string.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.  The keys' slots are
+    // prefetched a batch at a time before any of them is compared.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // version() returns a number that changes whenever the set's elements
+    // might have (see SetVersion.hpp).
+    unsigned long long version() const noexcept;
+
+
+    // reserve() makes room for at least count elements whose lengths add up
+    // to at least characters, so that adding them neither grows the table
+    // nor moves the pool.
+    void reserve(unsigned int count, std::size_t characters);
+
+
+    // shrinkToFit() gives back any room in the pool that reserve() or the
+    // pool's own growth left unused.
+    void shrinkToFit();
+
+
+    // memoryUsage() returns the approximate number of bytes the set
+    // occupies.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    // A slot whose offset is EMPTY holds no element.
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+
+    // How many keys containsMany() hashes and prefetches at a time.
+    static constexpr unsigned int LOOKUP_BATCH_SIZE = 32;
+
+    struct Slot
+    {
+        std::uint32_t hash = 0;
+        std::uint32_t offset = EMPTY;
+        std::uint32_t length = 0;
+    };
+
+    std::string pool;
+    std::vector<Slot> slots;
+    unsigned int count;
+    SetVersion contents;
+
+    bool find(std::string_view word, std::uint32_t hash) const;
+    void place(const Slot& slot);
+    void rehash(unsigned int newCapacity);
+};
+
+
+
+template <typename K>
+bool PooledStringSet::contains(const K& key) const
+{
+    std::string_view word{key};
+    return find(word, DictionaryFormat::hash(word));
+}
+
+
+template <typename K>
+void PooledStringSet::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    found.assign(keys.size(), false);
+    if (slots.empty())
+        return;
+
+    std::uint32_t hashes[LOOKUP_BATCH_SIZE];
+    std::uint32_t mask = slots.size() - 1;
+    for (std::size_t first = 0; first < keys.size(); first += LOOKUP_BATCH_SIZE)
+    {
+        std::size_t n = std::min<std::size_t>(LOOKUP_BATCH_SIZE, keys.size() - first);
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            hashes[i] = DictionaryFormat::hash(std::string_view{keys[first+i]});
+            prefetch(&slots[hashes[i] & mask]);
+        }
+        for (std::size_t i = 0; i < n; i++)
+            found[first+i] = find(std::string_view{keys[first+i]}, hashes[i]);
+    }
+}
+
+
+
+#endif // POOLEDSTRINGSET_HPP
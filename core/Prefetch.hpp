@@ -0,0 +1,20 @@
+#ifndef PREFETCH_HPP
+#define PREFETCH_HPP
+
+
+
+// prefetch() asks the processor to start loading the cache line holding
+// the given address, so that a later access to it does not stall.  It is a
+// hint only and does nothing on compilers that do not support it.
+inline void prefetch(const void* address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+
+
+#endif // PREFETCH_HPP
@@ -0,0 +1,76 @@
+#ifndef SETVERSION_HPP
+#define SETVERSION_HPP
+
+#include <atomic>
+
+
+
+// A SetVersion is a number that a set keeps alongside its elements and
+// that changes whenever they might have: when the set is constructed,
+// assigned to or moved from, and when an element is added.  Versions are
+// drawn from one counter for the whole process, so no two sets, nor the
+// same set at two different times, ever share one, even when a set is
+// destroyed and another built at the same address.  Whatever remembers
+// results found in a set, such as a SuggestionCache, can compare versions
+// to tell whether those results are still good.
+class SetVersion
+{
+public:
+    SetVersion() noexcept
+        : value{next()}
+    {
+    }
+
+    SetVersion(const SetVersion&) noexcept
+        : value{next()}
+    {
+    }
+
+    SetVersion& operator=(const SetVersion&) noexcept
+    {
+        value = next();
+        return *this;
+    }
+
+    // A set that is moved from loses its elements, so it gets a new
+    // version too.
+    SetVersion(SetVersion&& v) noexcept
+        : value{next()}
+    {
+        v.bump();
+    }
+
+    SetVersion& operator=(SetVersion&& v) noexcept
+    {
+        value = next();
+        v.bump();
+        return *this;
+    }
+
+
+    // bump() gives the set a new version.
+    void bump() noexcept
+    {
+        value = next();
+    }
+
+
+    unsigned long long get() const noexcept
+    {
+        return value;
+    }
+
+
+private:
+    unsigned long long value;
+
+    static unsigned long long next() noexcept
+    {
+        static std::atomic<unsigned long long> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+};
+
+
+
+#endif // SETVERSION_HPP
@@ -0,0 +1,228 @@
+#include "Stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+namespace
+{
+    // The registry is created on first use, so that call sites in other
+    // translation units' static initializers find it ready, and never
+    // destroyed, so that it outlives them too.
+    struct Registry
+    {
+        std::mutex mutex;
+        std::map<std::string, std::unique_ptr<std::atomic<std::uint64_t>>> counters;
+        std::map<std::string, std::unique_ptr<Stats::Histogram>> histograms;
+    };
+
+
+    Registry& registry()
+    {
+        static Registry* r = new Registry;
+        return *r;
+    }
+
+
+    // highestBit() returns the index of the highest bit set in x, which
+    // must not be zero.
+    unsigned int highestBit(std::uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<unsigned int>(__builtin_clzll(x));
+#else
+        unsigned int i = 0;
+        while (x >>= 1)
+            i++;
+        return i;
+#endif
+    }
+
+
+    std::int64_t nanosecondsNow() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+
+namespace Stats
+{
+    Histogram::Histogram() noexcept
+    {
+        reset();
+    }
+
+
+    void Histogram::record(std::uint64_t value, std::uint64_t times) noexcept
+    {
+        if (times == 0)
+            return;
+
+        buckets[bucketOf(value)].fetch_add(times, std::memory_order_relaxed);
+        total.fetch_add(times, std::memory_order_relaxed);
+        sum.fetch_add(value * times, std::memory_order_relaxed);
+
+        std::uint64_t seen = largest.load(std::memory_order_relaxed);
+        while (value > seen && !largest.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+
+    std::uint64_t Histogram::count() const noexcept
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+
+    std::uint64_t Histogram::max() const noexcept
+    {
+        return largest.load(std::memory_order_relaxed);
+    }
+
+
+    double Histogram::mean() const noexcept
+    {
+        std::uint64_t n = count();
+        return n == 0 ? 0.0 : double(sum.load(std::memory_order_relaxed)) / n;
+    }
+
+
+    std::uint64_t Histogram::percentile(double fraction) const noexcept
+    {
+        std::uint64_t n = count();
+        if (n == 0)
+            return 0;
+
+        std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(fraction * n)));
+        std::uint64_t seen = 0;
+        for (unsigned int i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(upperBoundOf(i), max());
+        }
+        return max();
+    }
+
+
+    void Histogram::reset() noexcept
+    {
+        for (std::atomic<std::uint64_t>& bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        largest.store(0, std::memory_order_relaxed);
+    }
+
+
+    unsigned int Histogram::bucketOf(std::uint64_t value) noexcept
+    {
+        // Values from 2^e up to 2^(e+1) share SUB_BUCKETS buckets, told
+        // apart by the three bits below the highest.
+        if (value < SUB_BUCKETS)
+            return static_cast<unsigned int>(value);
+
+        unsigned int e = highestBit(value);
+        unsigned int sub = static_cast<unsigned int>(value >> (e - 3)) & (SUB_BUCKETS - 1);
+        return (e - 2) * SUB_BUCKETS + sub;
+    }
+
+
+    std::uint64_t Histogram::upperBoundOf(unsigned int bucket) noexcept
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        unsigned int e = bucket / SUB_BUCKETS + 2;
+        std::uint64_t sub = bucket % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub) << (e - 3)) + (std::uint64_t{1} << (e - 3)) - 1;
+    }
+
+
+
+    ScopedTimer::ScopedTimer(Histogram& histogram) noexcept
+        : histogram{histogram}, start{nanosecondsNow()}
+    {
+    }
+
+
+    ScopedTimer::~ScopedTimer() noexcept
+    {
+        histogram.record(static_cast<std::uint64_t>(nanosecondsNow() - start));
+    }
+
+
+
+    std::atomic<std::uint64_t>& counter(const std::string& name)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        std::unique_ptr<std::atomic<std::uint64_t>>& c = r.counters[name];
+        if (c == nullptr)
+            c = std::make_unique<std::atomic<std::uint64_t>>(0);
+        return *c;
+    }
+
+
+    Histogram& histogram(const std::string& name)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        std::unique_ptr<Histogram>& h = r.histograms[name];
+        if (h == nullptr)
+            h = std::make_unique<Histogram>();
+        return *h;
+    }
+
+
+    void dump(std::ostream& out)
+    {
+        if (!ENABLED)
+            out << "# statistics were not compiled in; build with WORDCHECKER_STATS=1\n";
+
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        for (const auto& c : r.counters)
+            out << "counter " << c.first << ' ' << c.second->load() << '\n';
+
+        for (const auto& h : r.histograms)
+        {
+            const Histogram& histogram = *h.second;
+            out << "histogram " << h.first
+                << " count=" << histogram.count()
+                << " mean=" << histogram.mean()
+                << " p50=" << histogram.percentile(0.50)
+                << " p90=" << histogram.percentile(0.90)
+                << " p99=" << histogram.percentile(0.99)
+                << " p999=" << histogram.percentile(0.999)
+                << " max=" << histogram.max() << '\n';
+        }
+    }
+
+
+    bool dumpToFile(const std::string& path)
+    {
+        std::ofstream file{path};
+        dump(file);
+        file.close();
+        return !file.fail();
+    }
+
+
+    void reset()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        for (const auto& c : r.counters)
+            c.second->store(0);
+        for (const auto& h : r.histograms)
+            h.second->reset();
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+
+// Stats counts what happens on the hot paths (how many candidates each
+// generator produces, how long lookups and resizes take) so that it can be
+// seen where the time goes.  It is compiled in only when WORDCHECKER_STATS
+// is defined to something other than 0; otherwise the STATS_ macros below
+// expand to nothing and evaluate none of their arguments.
+//
+// Counters and histograms are created by name the first time they are
+// used and live until the program ends.  Each call site looks its own up
+// once and keeps a reference to it, so recording a value costs one or two
+// relaxed atomic additions.
+
+#ifndef WORDCHECKER_STATS
+#define WORDCHECKER_STATS 0
+#endif
+
+
+namespace Stats
+{
+    constexpr bool ENABLED = WORDCHECKER_STATS != 0;
+
+
+    // A Histogram counts values in buckets that are an eighth of a power of
+    // two wide, so that any percentile it reports is within an eighth of
+    // the true value however large the values are.  Values below eight
+    // are counted exactly.
+    class Histogram
+    {
+    public:
+        static constexpr unsigned int SUB_BUCKETS = 8;
+        static constexpr unsigned int BUCKETS = (64 - 2) * SUB_BUCKETS;
+
+    public:
+        Histogram() noexcept;
+
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        // record() counts the given value the given number of times.
+        void record(std::uint64_t value, std::uint64_t times = 1) noexcept;
+
+        std::uint64_t count() const noexcept;
+        std::uint64_t max() const noexcept;
+        double mean() const noexcept;
+
+        // percentile() returns the value that the given fraction, from 0
+        // to 1, of the recorded values are no greater than, rounded up to
+        // the top of its bucket.
+        std::uint64_t percentile(double fraction) const noexcept;
+
+        void reset() noexcept;
+
+    private:
+        std::atomic<std::uint64_t> buckets[BUCKETS];
+        std::atomic<std::uint64_t> total;
+        std::atomic<std::uint64_t> sum;
+        std::atomic<std::uint64_t> largest;
+
+        static unsigned int bucketOf(std::uint64_t value) noexcept;
+        static std::uint64_t upperBoundOf(unsigned int bucket) noexcept;
+    };
+
+
+    // A ScopedTimer records the nanoseconds between its construction and
+    // its destruction into a histogram.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram& histogram) noexcept;
+        ~ScopedTimer() noexcept;
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram;
+        std::int64_t start;
+    };
+
+
+    // counter() and histogram() return the counter or histogram with the
+    // given name, creating it if there is none yet.
+    std::atomic<std::uint64_t>& counter(const std::string& name);
+    Histogram& histogram(const std::string& name);
+
+
+    // dump() writes every counter and histogram, sorted by name, one per
+    // line.  dumpToFile() writes them to the file at the given path,
+    // replacing it, and returns false if it cannot be written.
+    void dump(std::ostream& out);
+    bool dumpToFile(const std::string& path);
+
+
+    // reset() sets every counter and histogram back to zero.
+    void reset();
+}
+
+
+#define STATS_CONCAT_(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_(a, b)
+
+#if WORDCHECKER_STATS
+
+// STATS_COUNT(name) adds one to the named counter.
+#define STATS_COUNT(name) \
+    do \
+    { \
+        static std::atomic<std::uint64_t>& statsCounter_ = ::Stats::counter(name); \
+        statsCounter_.fetch_add(1, std::memory_order_relaxed); \
+    } while (false)
+
+// STATS_RECORD(name, value) records a value in the named histogram.
+#define STATS_RECORD(name, value) \
+    do \
+    { \
+        static ::Stats::Histogram& statsHistogram_ = ::Stats::histogram(name); \
+        statsHistogram_.record(value); \
+    } while (false)
+
+// STATS_TIME(name) records how long the rest of the enclosing block takes
+// in the named histogram, in nanoseconds.
+#define STATS_TIME(name) \
+    static ::Stats::Histogram& STATS_CONCAT(statsTimed_, __LINE__) = ::Stats::histogram(name); \
+    ::Stats::ScopedTimer STATS_CONCAT(statsTimer_, __LINE__){STATS_CONCAT(statsTimed_, __LINE__)}
+
+#else
+
+#define STATS_COUNT(name) do { } while (false)
+#define STATS_RECORD(name, value) do { } while (false)
+#define STATS_TIME(name) do { } while (false)
+
+#endif
+
+
+
+#endif // STATS_HPP
@@ -0,0 +1,209 @@
+#include "StreamChecker.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include "Tokenizer.hpp"
+
+
+namespace
+{
+    // A ChunkQueue hands buffers from one thread to another.  pop() waits
+    // for a buffer until the queue is closed.
+    class ChunkQueue
+    {
+    public:
+        void push(std::string chunk)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                chunks.push_back(std::move(chunk));
+            }
+            ready.notify_one();
+        }
+
+        bool pop(std::string& chunk)
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            ready.wait(lock, [this] { return !chunks.empty() || closed; });
+            if (chunks.empty())
+                return false;
+
+            chunk = std::move(chunks.front());
+            chunks.pop_front();
+            return true;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                closed = true;
+            }
+            ready.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::string> chunks;
+        bool closed = false;
+    };
+}
+
+
+StreamChecker::StreamChecker(const WordChecker& checker, WorkStealingPool* pool, std::size_t chunkSize)
+    : checker{checker}, pool{pool}, chunkSize{std::max<std::size_t>(chunkSize, 1)}, maxSuggestions{0},
+      maxDistance{0}
+{
+}
+
+
+std::size_t StreamChecker::check(std::istream& input, const std::function<void(const Misspelling&)>& report)
+{
+    // Buffers go round in a loop: the reader takes an empty one, fills it
+    // and passes it on, and the checker appends it to its text and hands
+    // it back.  There are only ever CHUNKS_AHEAD of them, which bounds how
+    // far ahead the reader can get and how much memory it uses.
+    ChunkQueue empty;
+    ChunkQueue filled;
+    for (std::size_t i = 0; i < CHUNKS_AHEAD; i++)
+        empty.push(std::string{});
+
+    bool readFailed = false;
+    std::thread reader{[&]
+    {
+        std::string chunk;
+        while (empty.pop(chunk))
+        {
+            chunk.resize(chunkSize);
+            input.read(&chunk[0], chunkSize);
+            chunk.resize(static_cast<std::size_t>(input.gcount()));
+            readFailed = input.bad();
+
+            bool more = chunk.size() == chunkSize && !readFailed;
+            if (!chunk.empty())
+                filled.push(std::move(chunk));
+            if (!more)
+                break;
+        }
+        filled.close();
+    }};
+
+    Tokenizer tokenizer;
+    std::vector<std::string_view> tokens;
+    std::vector<Misspelling> misspellings;
+    std::vector<std::string_view> misspelled;
+    std::string word;
+
+    // text holds the chunk being checked, after whatever was left over at
+    // the end of the previous one; start is its offset in the input, and
+    // line is the number of the line that it starts on.
+    std::string text;
+    std::size_t start = 0;
+    std::size_t line = 1;
+    std::size_t reported = 0;
+
+    try
+    {
+        bool last = false;
+        while (!last)
+        {
+            std::string chunk;
+            if (filled.pop(chunk))
+            {
+                text.append(chunk);
+                empty.push(std::move(chunk));
+            }
+            else
+                last = true;
+
+            // A word is held back when it may go on into the next chunk,
+            // unless nothing else was found, which only happens when a
+            // word is longer than a chunk.  Such a word is cut in two.
+            std::size_t consumed = tokenizer.tokenize(text, tokens, last);
+            if (consumed == 0 && text.size() >= chunkSize)
+                consumed = tokenizer.tokenize(text, tokens, true);
+
+            misspellings.clear();
+            misspelled.clear();
+            std::size_t scanned = 0;
+            for (std::string_view token : tokens)
+            {
+                word.assign(token);
+                if (checker.wordExists(word))
+                    continue;
+
+                std::size_t offset = tokenizer.offsetOf(token);
+                line += std::count(text.begin() + scanned, text.begin() + offset, '\n');
+                scanned = offset;
+
+                Misspelling m;
+                m.offset = start + offset;
+                m.line = line;
+                m.word.assign(text, offset, token.size());
+                misspellings.push_back(std::move(m));
+                misspelled.push_back(token);
+            }
+            line += std::count(text.begin() + scanned, text.begin() + consumed, '\n');
+
+            auto suggest = [&](std::size_t i)
+            {
+                std::string misspelling{misspelled[i]};
+                std::vector<std::string>& suggestions = misspellings[i].suggestions;
+                if (maxDistance > 0)
+                {
+                    suggestions = checker.findNearSuggestions(misspelling, maxDistance);
+                    if (maxSuggestions > 0 && suggestions.size() > maxSuggestions)
+                        suggestions.resize(maxSuggestions);
+                }
+                else if (maxSuggestions > 0)
+                    suggestions = checker.findTopSuggestions(misspelling, maxSuggestions);
+                else
+                    suggestions = checker.findSuggestions(misspelling);
+            };
+            if (pool != nullptr && misspellings.size() > 1)
+                pool->parallelFor(misspellings.size(), suggest);
+            else
+            {
+                for (std::size_t i = 0; i < misspellings.size(); i++)
+                    suggest(i);
+            }
+
+            for (const Misspelling& m : misspellings)
+                report(m);
+            reported += misspellings.size();
+
+            text.erase(0, consumed);
+            start += consumed;
+        }
+    }
+    catch (...)
+    {
+        empty.close();
+        reader.join();
+        throw;
+    }
+
+    empty.close();
+    reader.join();
+
+    if (readFailed)
+        throw StreamCheckException{"could not read input"};
+
+    return reported;
+}
+
+
+void StreamChecker::limitSuggestions(std::size_t k) noexcept
+{
+    maxSuggestions = k;
+}
+
+
+void StreamChecker::suggestWithin(unsigned int maxDistance) noexcept
+{
+    this->maxDistance = maxDistance;
+}
@@ -0,0 +1,107 @@
+#ifndef STREAMCHECKER_HPP
+#define STREAMCHECKER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+#include "WordChecker.hpp"
+#include "WorkStealingPool.hpp"
+
+
+
+// A Misspelling is a word of the input that is not in the dictionary.
+struct Misspelling
+{
+    // The word's offset in bytes from the start of the input, and the
+    // number of the line it is on, counting from 1.
+    std::size_t offset = 0;
+    std::size_t line = 0;
+
+    // The word as it appears in the input.
+    std::string word;
+
+    std::vector<std::string> suggestions;
+};
+
+
+
+// A StreamChecker checks a stream of text of any length for misspellings,
+// holding no more than a few chunks of it in memory at once.
+//
+// The work is pipelined: a thread of its own reads the next chunks while
+// the calling thread tokenizes and checks the current one, and the
+// suggestions for a chunk's misspellings are found on a WorkStealingPool
+// when one is given.  Misspellings are reported in the order they appear.
+class StreamChecker
+{
+public:
+    // How many bytes are read at a time when no chunk size is given.
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    // How many chunks can be read ahead of the one being checked.
+    static constexpr std::size_t CHUNKS_AHEAD = 2;
+
+public:
+    // Initializes a StreamChecker that checks words with the given
+    // checker, which must outlive it.  Passing a pool finds suggestions on
+    // its threads; passing nullptr finds them on the calling thread.
+    StreamChecker(
+        const WordChecker& checker, WorkStealingPool* pool = nullptr,
+        std::size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+
+    // check() reads input to its end and calls report once for every
+    // misspelling in it, in order, on the calling thread.  It returns the
+    // number of misspellings reported.  A StreamCheckException is thrown
+    // if input cannot be read; anything report throws is rethrown after
+    // the reading thread has stopped.
+    std::size_t check(std::istream& input, const std::function<void(const Misspelling&)>& report);
+
+
+    // limitSuggestions() makes check() report only the best k suggestions
+    // for each misspelling, found by findTopSuggestions().  Passing 0
+    // reports every suggestion, as findSuggestions() finds them.
+    void limitSuggestions(std::size_t k) noexcept;
+
+
+    // suggestWithin() makes check() report the words within maxDistance
+    // edits of each misspelling, found by findNearSuggestions(), and no
+    // more than the limit given to limitSuggestions() of them.  Passing 0
+    // goes back to the suggestions one edit away.
+    void suggestWithin(unsigned int maxDistance) noexcept;
+
+
+private:
+    const WordChecker& checker;
+    WorkStealingPool* pool;
+    std::size_t chunkSize;
+    std::size_t maxSuggestions;
+    unsigned int maxDistance;
+};
+
+
+
+// A StreamCheckException is thrown when the input to a StreamChecker
+// cannot be read.
+class StreamCheckException
+{
+public:
+    StreamCheckException(const std::string& reason)
+        : reason_{reason}
+    {
+    }
+
+    const std::string& reason() const
+    {
+        return reason_;
+    }
+
+private:
+    std::string reason_;
+};
+
+
+
+#endif // STREAMCHECKER_HPP
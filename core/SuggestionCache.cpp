@@ -0,0 +1,151 @@
+#include "SuggestionCache.hpp"
+#include <algorithm>
+#include <cstdint>
+
+
+SuggestionCache::SuggestionCache(std::size_t capacity, unsigned int shardCount)
+    : generations{0}
+{
+    // No shard is given less than one word, so a small cache has fewer
+    // shards; capacity() can come out a little below what was asked.
+    this->shardCount = static_cast<unsigned int>(
+        std::max<std::size_t>(1, std::min<std::size_t>(shardCount, capacity)));
+    shardCapacity = capacity / this->shardCount;
+    shards = std::make_unique<Shard[]>(this->shardCount);
+}
+
+
+SuggestionCache::~SuggestionCache() noexcept = default;
+
+
+bool SuggestionCache::find(std::string_view word, const Stamp& stamp, std::vector<std::string>& suggestions)
+{
+    Shard& shard = shardOf(word);
+    std::shared_ptr<const std::vector<std::string>> found;
+    {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        auto i = shard.index.find(word);
+        if (i == shard.index.end() || i->second->stamp != stamp)
+        {
+            shard.stats.misses++;
+            return false;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, i->second);
+        found = i->second->suggestions;
+        shard.stats.hits++;
+    }
+
+    // The suggestions are shared and never modified, so they are copied
+    // after the lock is released.
+    suggestions = *found;
+    return true;
+}
+
+
+unsigned long long SuggestionCache::generation() const noexcept
+{
+    return generations.load();
+}
+
+
+void SuggestionCache::insert(
+    std::string_view word, const Stamp& stamp, unsigned long long generation,
+    std::vector<std::string> suggestions)
+{
+    if (shardCapacity == 0)
+        return;
+
+    auto shared = std::make_shared<const std::vector<std::string>>(std::move(suggestions));
+    Shard& shard = shardOf(word);
+    std::lock_guard<std::mutex> lock{shard.mutex};
+
+    // invalidate() changes the generation before it empties the shards,
+    // so anything inserted after this check is emptied along with the
+    // rest.
+    if (generations.load() != generation)
+        return;
+
+    auto i = shard.index.find(word);
+    if (i != shard.index.end())
+    {
+        // Another thread found the same word first, or the entry is from
+        // an earlier dictionary; either way the newer suggestions win.
+        i->second->stamp = stamp;
+        i->second->suggestions = std::move(shared);
+        shard.entries.splice(shard.entries.begin(), shard.entries, i->second);
+        return;
+    }
+
+    if (shard.entries.size() >= shardCapacity)
+    {
+        shard.index.erase(shard.entries.back().word);
+        shard.entries.pop_back();
+        shard.stats.evictions++;
+    }
+
+    shard.entries.push_front(Entry{std::string{word}, stamp, std::move(shared)});
+    shard.index.emplace(shard.entries.front().word, shard.entries.begin());
+    shard.stats.insertions++;
+}
+
+
+void SuggestionCache::invalidate()
+{
+    generations.fetch_add(1);
+    for (unsigned int i = 0; i < shardCount; i++)
+    {
+        // The entries are destroyed outside the lock.
+        std::list<Entry> dropped;
+        {
+            std::lock_guard<std::mutex> lock{shards[i].mutex};
+            shards[i].stats.invalidations += shards[i].entries.size();
+            shards[i].index.clear();
+            dropped.swap(shards[i].entries);
+        }
+    }
+}
+
+
+std::size_t SuggestionCache::size() const
+{
+    std::size_t total = 0;
+    for (unsigned int i = 0; i < shardCount; i++)
+    {
+        std::lock_guard<std::mutex> lock{shards[i].mutex};
+        total += shards[i].entries.size();
+    }
+    return total;
+}
+
+
+std::size_t SuggestionCache::capacity() const noexcept
+{
+    return shardCapacity * shardCount;
+}
+
+
+SuggestionCache::Counters SuggestionCache::counters() const
+{
+    Counters total;
+    for (unsigned int i = 0; i < shardCount; i++)
+    {
+        std::lock_guard<std::mutex> lock{shards[i].mutex};
+        const Counters& c = shards[i].stats;
+        total.hits += c.hits;
+        total.misses += c.misses;
+        total.insertions += c.insertions;
+        total.evictions += c.evictions;
+        total.invalidations += c.invalidations;
+    }
+    return total;
+}
+
+
+SuggestionCache::Shard& SuggestionCache::shardOf(std::string_view word) const noexcept
+{
+    // The shard comes from the hash's upper half, so that words are
+    // spread evenly over any number of shards without a division.
+    std::uint64_t hash = StringHash{}(word);
+    return shards[((hash >> 32) * shardCount) >> 32];
+}
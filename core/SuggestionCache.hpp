@@ -0,0 +1,150 @@
+#ifndef SUGGESTIONCACHE_HPP
+#define SUGGESTIONCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "HashPolicies.hpp"
+
+
+
+// A SuggestionCache remembers the suggestions found for misspelled words,
+// so that a typo that recurs throughout a text is only worked out once.
+// It holds at most a fixed number of words, forgetting the least recently
+// used when it is full, and is safe to use from many threads at once.
+//
+// The words are spread over shards by their hash, each with its own lock
+// and its own least-recently-used order, so that threads looking up
+// different words rarely wait for each other.
+//
+// Suggestions depend on the dictionary they were found in, so every entry
+// carries a Stamp of that dictionary and is only returned to a lookup with
+// the same stamp.  A checker's stamp is its set's address and version (see
+// SetVersion.hpp), which changes whenever the set is added to, assigned
+// to or rebuilt, even at the same address.  A set that has no version
+// is stamped with its size instead, which misses an assignment that
+// leaves the size the same; a checker over such a set should be given a
+// cache that is invalidate()d whenever the set changes.  A dictionary
+// replaced through a DictionaryHandle may reuse the address of the one it
+// replaced, so the handle calls invalidate() when it publishes.
+class SuggestionCache
+{
+public:
+    // The number of shards used when none is given.
+    static constexpr unsigned int DEFAULT_SHARD_COUNT = 16;
+
+    // A Stamp identifies the contents of the dictionary that suggestions
+    // were found in.
+    struct Stamp
+    {
+        const void* dictionary;
+        unsigned long long version;
+
+        bool operator==(const Stamp& s) const noexcept
+        {
+            return dictionary == s.dictionary && version == s.version;
+        }
+
+        bool operator!=(const Stamp& s) const noexcept
+        {
+            return !(*this == s);
+        }
+    };
+
+    // Counters records how the cache has been used since it was created.
+    struct Counters
+    {
+        // Lookups that found the word with a matching stamp, and those
+        // that did not.
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+
+        // Entries added, and those dropped to make room for them.
+        std::size_t insertions = 0;
+        std::size_t evictions = 0;
+
+        // Entries dropped because their dictionary changed.
+        std::size_t invalidations = 0;
+    };
+
+public:
+    // Initializes an empty cache that holds at most capacity words,
+    // spread over the given number of shards.
+    explicit SuggestionCache(std::size_t capacity, unsigned int shardCount = DEFAULT_SHARD_COUNT);
+
+    ~SuggestionCache() noexcept;
+
+    SuggestionCache(const SuggestionCache&) = delete;
+    SuggestionCache& operator=(const SuggestionCache&) = delete;
+
+
+    // find() copies the suggestions cached for the given word into
+    // suggestions and returns true if there are any for a dictionary with
+    // the given stamp, and returns false otherwise.
+    bool find(std::string_view word, const Stamp& stamp, std::vector<std::string>& suggestions);
+
+
+    // generation() returns a number that changes every time invalidate()
+    // is called.  It is read before finding suggestions to insert, so that
+    // suggestions found while the dictionary was being replaced are not
+    // cached.
+    unsigned long long generation() const noexcept;
+
+
+    // insert() caches the suggestions for the given word, found in a
+    // dictionary with the given stamp, unless invalidate() has been called
+    // since generation() returned the given generation.
+    void insert(
+        std::string_view word, const Stamp& stamp, unsigned long long generation,
+        std::vector<std::string> suggestions);
+
+
+    // invalidate() forgets every word.
+    void invalidate();
+
+
+    // size() returns the number of words cached.
+    std::size_t size() const;
+
+    std::size_t capacity() const noexcept;
+
+    // counters() adds together the counters of every shard.
+    Counters counters() const;
+
+
+private:
+    struct Entry
+    {
+        std::string word;
+        Stamp stamp;
+        std::shared_ptr<const std::vector<std::string>> suggestions;
+    };
+
+    // Each shard keeps its entries in a list from most to least recently
+    // used, and indexes them by word.  The index's keys are views of the
+    // words in the list, whose nodes never move.
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<std::string_view, std::list<Entry>::iterator, StringHash> index;
+        Counters stats;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    unsigned int shardCount;
+    std::size_t shardCapacity;
+    std::atomic<unsigned long long> generations;
+
+    Shard& shardOf(std::string_view word) const noexcept;
+};
+
+
+
+#endif // SUGGESTIONCACHE_HPP
@@ -0,0 +1,108 @@
+#include "SuggestionRange.hpp"
+
+
+SuggestionRange::SuggestionRange(std::string word, StageFunction runStage)
+    : word{std::move(word)}, runStage{std::move(runStage)}, nextStage{0}, moreStages{true}, position{0}
+{
+}
+
+
+SuggestionRange::iterator SuggestionRange::begin()
+{
+    return fill() ? iterator{this} : end();
+}
+
+
+SuggestionRange::iterator SuggestionRange::end() noexcept
+{
+    return iterator{};
+}
+
+
+bool SuggestionRange::empty()
+{
+    return !fill();
+}
+
+
+bool SuggestionRange::fill()
+{
+    while (position == found.size())
+    {
+        if (!moreStages)
+            return false;
+
+        found.clear();
+        position = 0;
+        moreStages = runStage(word, nextStage++, found);
+    }
+    return true;
+}
+
+
+
+SuggestionRange::PostIncremented::PostIncremented(std::string suggestion)
+    : suggestion{std::move(suggestion)}
+{
+}
+
+
+const std::string& SuggestionRange::PostIncremented::operator*() const noexcept
+{
+    return suggestion;
+}
+
+
+
+SuggestionRange::iterator::iterator() noexcept
+    : range{nullptr}
+{
+}
+
+
+SuggestionRange::iterator::iterator(SuggestionRange* range) noexcept
+    : range{range}
+{
+}
+
+
+SuggestionRange::iterator::reference SuggestionRange::iterator::operator*() const
+{
+    return range->found[range->position];
+}
+
+
+SuggestionRange::iterator::pointer SuggestionRange::iterator::operator->() const
+{
+    return &range->found[range->position];
+}
+
+
+SuggestionRange::iterator& SuggestionRange::iterator::operator++()
+{
+    // Once the range runs out, the iterator becomes equal to end().
+    range->position++;
+    if (!range->fill())
+        range = nullptr;
+    return *this;
+}
+
+
+SuggestionRange::PostIncremented SuggestionRange::iterator::operator++(int)
+{
+    PostIncremented previous{**this};
+    ++*this;
+    return previous;
+}
+
+
+bool SuggestionRange::iterator::operator==(const iterator& i) const
+{
+    return range == i.range;
+}
+
+
+bool SuggestionRange::iterator::operator!=(const iterator& i) const
+{
+    return range != i.range;
+}
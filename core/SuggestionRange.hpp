@@ -0,0 +1,116 @@
+#ifndef SUGGESTIONRANGE_HPP
+#define SUGGESTIONRANGE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+
+// A SuggestionRange yields the suggestions for a word lazily, in the same
+// order findSuggestions() returns them.  The suggestions are found one
+// kind of edit at a time, and each kind is only tried once iteration has
+// used up what the earlier ones found, so a caller that stops after the
+// first suggestion, or only asks whether there are any, never pays for the
+// rest:
+//
+//     for (const std::string& suggestion : checker.suggestions(word))
+//     {
+//         if (good enough)
+//             break;
+//     }
+//
+// A range must not outlive the checker that returned it.  Its iterators
+// are input iterators: they all share the range's position, and a
+// suggestion they refer to stays valid until they are incremented.
+class SuggestionRange
+{
+public:
+    // A StageFunction finds the suggestions for the word that the given
+    // stage of the search yields, appending them to found.  It returns
+    // true if there are later stages.
+    typedef std::function<bool(const std::string& word, unsigned int stage, std::vector<std::string>& found)>
+        StageFunction;
+
+
+    // A PostIncremented holds the suggestion an iterator referred to
+    // before it was post-incremented, since all iterators of a range move
+    // together.
+    class PostIncremented
+    {
+    public:
+        explicit PostIncremented(std::string suggestion);
+        const std::string& operator*() const noexcept;
+
+    private:
+        std::string suggestion;
+    };
+
+
+    class iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::string value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::string* pointer;
+        typedef const std::string& reference;
+
+    public:
+        iterator() noexcept;
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        iterator& operator++();
+        PostIncremented operator++(int);
+
+        bool operator==(const iterator& i) const;
+        bool operator!=(const iterator& i) const;
+
+    private:
+        friend class SuggestionRange;
+        explicit iterator(SuggestionRange* range) noexcept;
+
+        SuggestionRange* range;
+    };
+
+
+public:
+    // Initializes a range of the suggestions for the given word, found by
+    // calling runStage with stages 0, 1, 2 and so on until it returns
+    // false.  Nothing is found until the range is first iterated.
+    SuggestionRange(std::string word, StageFunction runStage);
+
+
+    // begin() finds the first suggestion, if it has not been found yet.
+    iterator begin();
+    iterator end() noexcept;
+
+
+    // empty() returns true if there are no suggestions left to iterate,
+    // finding as few of them as it takes to tell.
+    bool empty();
+
+
+private:
+    std::string word;
+    StageFunction runStage;
+    unsigned int nextStage;
+    bool moreStages;
+
+    // The suggestions of the stage being iterated, and the position in
+    // them of the current one.
+    std::vector<std::string> found;
+    std::size_t position;
+
+    // fill() runs stages until one yields a suggestion or none are left,
+    // returning false in the latter case.
+    bool fill();
+};
+
+
+
+#endif // SUGGESTIONRANGE_HPP
@@ -0,0 +1,220 @@
+#include "Tokenizer.hpp"
+#include "TokenizerKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define TOKENIZER_X86 1
+#endif
+
+
+namespace
+{
+    // The text is processed in blocks of 64 bytes; see TokenizerKernels.hpp
+    // for what a Classifier does with one.
+    using TokenizerKernels::Classifier;
+    using TokenizerKernels::Dispatch;
+
+
+    std::uint64_t classifyScalar(const char* in, char* out)
+    {
+        std::uint64_t mask = 0;
+        for (unsigned int i = 0; i < 64; i++)
+        {
+            char c = in[i];
+            bool lower = c >= 'a' && c <= 'z';
+            bool letter = lower || (c >= 'A' && c <= 'Z');
+            out[i] = lower ? c - ('a' - 'A') : c;
+            mask |= std::uint64_t{letter} << i;
+        }
+        return mask;
+    }
+
+
+#ifdef TOKENIZER_X86
+    // Bytes are compared as signed, so bytes outside of ASCII are negative
+    // and never fall within a range of letters.
+    std::uint64_t classifySse2(const char* in, char* out)
+    {
+        const __m128i lowerFirst = _mm_set1_epi8('a' - 1);
+        const __m128i lowerLast = _mm_set1_epi8('z' + 1);
+        const __m128i upperFirst = _mm_set1_epi8('A' - 1);
+        const __m128i upperLast = _mm_set1_epi8('Z' + 1);
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+
+        std::uint64_t mask = 0;
+        for (unsigned int i = 0; i < 64; i += 16)
+        {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, lowerFirst), _mm_cmplt_epi8(c, lowerLast));
+            __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, upperFirst), _mm_cmplt_epi8(c, upperLast));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi8(c, _mm_and_si128(lower, caseBit)));
+            std::uint64_t letters = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(lower, upper)));
+            mask |= letters << i;
+        }
+        return mask;
+    }
+
+
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((target("avx2")))
+    std::uint64_t classifyAvx2(const char* in, char* out)
+    {
+        const __m256i lowerFirst = _mm256_set1_epi8('a' - 1);
+        const __m256i lowerLast = _mm256_set1_epi8('z' + 1);
+        const __m256i upperFirst = _mm256_set1_epi8('A' - 1);
+        const __m256i upperLast = _mm256_set1_epi8('Z' + 1);
+        const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+        std::uint64_t mask = 0;
+        for (unsigned int i = 0; i < 64; i += 32)
+        {
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, lowerFirst), _mm256_cmpgt_epi8(lowerLast, c));
+            __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, upperFirst), _mm256_cmpgt_epi8(upperLast, c));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi8(c, _mm256_and_si256(lower, caseBit)));
+            std::uint64_t letters = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(lower, upper)));
+            mask |= letters << i;
+        }
+        return mask;
+    }
+#define TOKENIZER_AVX2 1
+#endif
+#endif
+
+
+    // The best classifier for the processor the program is running on is
+    // found once.
+    Dispatch chooseClassifier()
+    {
+#ifdef TOKENIZER_AVX2
+        if (__builtin_cpu_supports("avx2"))
+            return {classifyAvx2, "avx2"};
+#endif
+#ifdef TOKENIZER_X86
+        return {classifySse2, "sse2"};
+#else
+        return {classifyScalar, "scalar"};
+#endif
+    }
+
+    const Dispatch best = chooseClassifier();
+    const Dispatch scalar = {classifyScalar, "scalar"};
+
+
+    int lowestBit(std::uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int i = 0;
+        while ((x & 1) == 0)
+        {
+            x >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+}
+
+
+namespace TokenizerKernels
+{
+    Dispatch scalar() noexcept
+    {
+        return ::scalar;
+    }
+
+
+    std::vector<Dispatch> vectorized()
+    {
+        std::vector<Dispatch> classifiers;
+#ifdef TOKENIZER_X86
+        classifiers.push_back({classifySse2, "sse2"});
+#endif
+#ifdef TOKENIZER_AVX2
+        if (__builtin_cpu_supports("avx2"))
+            classifiers.push_back({classifyAvx2, "avx2"});
+#endif
+        return classifiers;
+    }
+}
+
+
+Tokenizer::Tokenizer(bool vectorized)
+    : classify{vectorized ? best.classify : scalar.classify},
+      name{vectorized ? best.name : scalar.name}
+{
+}
+
+
+std::size_t Tokenizer::tokenize(std::string_view input, std::vector<std::string_view>& tokens, bool last)
+{
+    tokens.clear();
+
+    // The last partial block is classified from a padded copy, so that the
+    // classifiers can always read and write whole blocks.  Padding with
+    // spaces also ends any word that runs to the end of the input.
+    std::size_t blocks = (input.size() + 63) / 64;
+    upper.resize(blocks * 64);
+    char padded[64];
+
+    // Bit i of transitions is set where byte i starts or ends a word, by
+    // comparing each byte's mask bit with the one before it.  Starts and
+    // ends alternate, so which one a transition is follows from whether a
+    // word is open.
+    std::uint64_t previous = 0;
+    std::size_t start = 0;
+    bool open = false;
+    for (std::size_t b = 0; b < blocks; b++)
+    {
+        std::size_t base = b * 64;
+        const char* in = input.data() + base;
+        if (base + 64 > input.size())
+        {
+            std::size_t count = input.size() - base;
+            for (std::size_t i = 0; i < 64; i++)
+                padded[i] = i < count ? in[i] : ' ';
+            in = padded;
+        }
+
+        std::uint64_t mask = classify(in, &upper[base]);
+        std::uint64_t transitions = mask ^ ((mask << 1) | previous);
+        previous = mask >> 63;
+
+        while (transitions != 0)
+        {
+            std::size_t position = base + lowestBit(transitions);
+            transitions &= transitions - 1;
+            if (open)
+                tokens.emplace_back(upper.data() + start, position - start);
+            else
+                start = position;
+            open = !open;
+        }
+    }
+
+    if (open)
+        tokens.emplace_back(upper.data() + start, input.size() - start);
+
+    if (!last && !tokens.empty() && offsetOf(tokens.back()) + tokens.back().size() == input.size())
+    {
+        std::size_t consumed = offsetOf(tokens.back());
+        tokens.pop_back();
+        return consumed;
+    }
+    return input.size();
+}
+
+
+std::size_t Tokenizer::offsetOf(std::string_view token) const noexcept
+{
+    return token.data() - upper.data();
+}
+
+
+const char* Tokenizer::instructionSet() const noexcept
+{
+    return name;
+}
+
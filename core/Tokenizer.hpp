@@ -0,0 +1,65 @@
+#ifndef TOKENIZER_HPP
+#define TOKENIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// A Tokenizer splits text into words and uppercases them, so that they can
+// be checked against a dictionary of uppercase words.  A word is a run of
+// ASCII letters; everything else, including bytes outside of ASCII,
+// separates words.
+//
+// The text is classified and uppercased 32 or 16 bytes at a time with
+// AVX2 or SSE2 instructions when the processor has them, and a byte at a
+// time otherwise.  Tokens are views into the Tokenizer's own uppercased
+// copy of the text, which is reused from one call to the next, so
+// tokenizing allocates nothing once the buffers have grown to size.
+class Tokenizer
+{
+public:
+    // Initializes a Tokenizer with empty buffers.  Passing false for
+    // vectorized makes it work a byte at a time even when the processor
+    // has vector instructions, which is mainly useful for comparison.
+    explicit Tokenizer(bool vectorized = true);
+
+
+    // tokenize() replaces the contents of tokens with the words in input,
+    // uppercased, and returns the number of bytes of input it consumed.
+    // The tokens stay valid until tokenize() is next called.
+    //
+    // When input is one chunk of a longer stream and more of it follows,
+    // passing false for last leaves out a word that runs up to the end of
+    // the chunk, since it may continue in the next one; the return value
+    // then stops short of that word, and the caller passes it again at the
+    // start of the next chunk.
+    std::size_t tokenize(std::string_view input, std::vector<std::string_view>& tokens, bool last = true);
+
+
+    // offsetOf() returns the offset, in the input last given to
+    // tokenize(), of a token that tokenize() returned.
+    std::size_t offsetOf(std::string_view token) const noexcept;
+
+
+    // instructionSet() returns the name of the instructions that
+    // tokenize() uses: "avx2", "sse2" or "scalar".
+    const char* instructionSet() const noexcept;
+
+
+private:
+    // A Classifier uppercases one 64-byte block of text and returns a mask
+    // of which of its bytes are letters.
+    typedef std::uint64_t (*Classifier)(const char* in, char* out);
+
+    std::string upper;
+    Classifier classify;
+    const char* name;
+};
+
+
+
+#endif // TOKENIZER_HPP
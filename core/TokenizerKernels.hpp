@@ -0,0 +1,36 @@
+#ifndef TOKENIZERKERNELS_HPP
+#define TOKENIZERKERNELS_HPP
+
+#include <cstdint>
+#include <vector>
+
+
+
+// TokenizerKernels exposes the block classifiers that Tokenizer chooses
+// among at run time, so that bench/KernelCheck can compare them.  It is
+// not part of Tokenizer's interface; nothing else should include it.
+namespace TokenizerKernels
+{
+    // A Classifier uppercases one 64-byte block of text into out and
+    // returns a mask with bit i set when byte i is a letter.
+    typedef std::uint64_t (*Classifier)(const char* in, char* out);
+
+    struct Dispatch
+    {
+        Classifier classify;
+        const char* name;
+    };
+
+
+    // scalar() returns the classifier that works a byte at a time.
+    Dispatch scalar() noexcept;
+
+
+    // vectorized() returns every classifier using vector instructions that
+    // the processor the program is running on supports.
+    std::vector<Dispatch> vectorized();
+}
+
+
+
+#endif // TOKENIZERKERNELS_HPP
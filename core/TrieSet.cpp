@@ -0,0 +1,290 @@
+#include "TrieSet.hpp"
+#include <algorithm>
+#include <limits>
+
+
+TrieSet::TrieSet()
+    : nodes(1), count{0}, minimized{false}
+{
+}
+
+
+TrieSet::TrieSet(TrieSet&& s)
+    : nodes(1), count{0}, minimized{false}
+{
+    // The expiring set is handed this one's empty trie, since every
+    // operation expects a root.
+    std::swap(nodes, s.nodes);
+    std::swap(count, s.count);
+    std::swap(minimized, s.minimized);
+    s.contents.bump();
+}
+
+
+TrieSet& TrieSet::operator=(TrieSet&& s) noexcept
+{
+    std::swap(nodes, s.nodes);
+    std::swap(count, s.count);
+    std::swap(minimized, s.minimized);
+    contents.bump();
+    s.contents.bump();
+    return *this;
+}
+
+
+bool TrieSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void TrieSet::add(const std::string& element)
+{
+    if (minimized)
+        expand();
+
+    unsigned int node = 0;
+    for (char letter : element)
+    {
+        // Walk the sibling list to the child for this letter, or to the
+        // place where it belongs if there is none yet.
+        unsigned int previous = 0;
+        unsigned int curr = nodes[node].firstChild;
+        while (curr != 0 && nodes[curr].letter < letter)
+        {
+            previous = curr;
+            curr = nodes[curr].nextSibling;
+        }
+
+        if (curr == 0 || nodes[curr].letter != letter)
+        {
+            Node created;
+            created.letter = letter;
+            created.nextSibling = curr;
+            nodes.push_back(created);
+            curr = nodes.size() - 1;
+
+            if (previous == 0)
+                nodes[node].firstChild = curr;
+            else
+                nodes[previous].nextSibling = curr;
+        }
+        node = curr;
+    }
+
+    if (!nodes[node].terminal)
+    {
+        nodes[node].terminal = true;
+        count++;
+        contents.bump();
+    }
+}
+
+
+bool TrieSet::contains(const std::string& element) const
+{
+    return find(element);
+}
+
+
+unsigned int TrieSet::size() const noexcept
+{
+    return count;
+}
+
+
+unsigned long long TrieSet::version() const noexcept
+{
+    return contents.get();
+}
+
+
+unsigned int TrieSet::nodeCount() const noexcept
+{
+    return nodes.size() - 1;
+}
+
+
+void TrieSet::minimize()
+{
+    std::vector<unsigned int> canonical(nodes.size(), std::numeric_limits<unsigned int>::max());
+    Registry registry;
+    std::vector<Node> minimal(1);
+
+    canonical[0] = 0;
+    minimal[0] = nodes[0];
+    minimal[0].firstChild = canonicalize(nodes[0].firstChild, canonical, registry, minimal);
+    nodes.swap(minimal);
+    minimized = true;
+}
+
+
+unsigned int TrieSet::nearWords(
+    std::string_view word, std::string_view alphabet,
+    std::vector<std::string>& found) const
+{
+    std::size_t first = found.size();
+    std::string path;
+    path.reserve(word.size() + 1);
+    unsigned int visited = 0;
+
+    searchNear(0, word, 0, alphabet, path, found, visited);
+
+    // Different edits can lead to the same word, such as deleting either
+    // letter of a doubled pair, so the new words are made unique.
+    std::sort(found.begin() + first, found.end());
+    found.erase(std::unique(found.begin() + first, found.end()), found.end());
+    return visited;
+}
+
+
+bool TrieSet::find(std::string_view word) const
+{
+    unsigned int node = 0;
+    for (char letter : word)
+    {
+        node = child(node, letter);
+        if (node == 0)
+            return false;
+    }
+    return nodes[node].terminal;
+}
+
+
+unsigned int TrieSet::child(unsigned int node, char letter) const
+{
+    unsigned int curr = nodes[node].firstChild;
+    while (curr != 0 && nodes[curr].letter < letter)
+        curr = nodes[curr].nextSibling;
+    if (curr != 0 && nodes[curr].letter == letter)
+        return curr;
+    return 0;
+}
+
+
+void TrieSet::expand()
+{
+    std::vector<std::string> words;
+    std::string path;
+    collect(0, path, words);
+
+    nodes.assign(1, Node{});
+    count = 0;
+    minimized = false;
+    for (const std::string& word : words)
+        add(word);
+}
+
+
+unsigned int TrieSet::canonicalize(
+    unsigned int node, std::vector<unsigned int>& canonical,
+    Registry& registry, std::vector<Node>& minimal) const
+{
+    // Nodes are merged bottom-up: once a node's child and sibling have
+    // been replaced by their canonical copies, two nodes are identical
+    // exactly when their letter, terminal flag, child and sibling match.
+    if (canonical[node] != std::numeric_limits<unsigned int>::max())
+        return canonical[node];
+
+    Node copy = nodes[node];
+    copy.firstChild = canonicalize(copy.firstChild, canonical, registry, minimal);
+    copy.nextSibling = canonicalize(copy.nextSibling, canonical, registry, minimal);
+
+    auto key = std::make_tuple(copy.letter, copy.terminal, copy.firstChild, copy.nextSibling);
+    auto found = registry.find(key);
+    if (found != registry.end())
+        canonical[node] = found->second;
+    else
+    {
+        minimal.push_back(copy);
+        canonical[node] = minimal.size() - 1;
+        registry.emplace(key, canonical[node]);
+    }
+    return canonical[node];
+}
+
+
+void TrieSet::collect(unsigned int node, std::string& path, std::vector<std::string>& words) const
+{
+    if (nodes[node].terminal)
+        words.push_back(path);
+    for (unsigned int c = nodes[node].firstChild; c != 0; c = nodes[c].nextSibling)
+    {
+        path.push_back(nodes[c].letter);
+        collect(c, path, words);
+        path.pop_back();
+    }
+}
+
+
+void TrieSet::searchNear(
+    unsigned int node, std::string_view word, std::size_t i,
+    std::string_view alphabet, std::string& path,
+    std::vector<std::string>& found, unsigned int& visited) const
+{
+    // Deleting word[i] spends the edit without moving in the trie.
+    if (i < word.size())
+        searchExact(node, word, i + 1, path, found, visited);
+    else if (nodes[node].terminal)
+        found.push_back(path);
+
+    for (unsigned int c = nodes[node].firstChild; c != 0; c = nodes[c].nextSibling)
+    {
+        visited++;
+        char letter = nodes[c].letter;
+        bool editable = alphabet.find(letter) != std::string_view::npos;
+        path.push_back(letter);
+
+        // Inserting this child's letter in front of word[i].
+        if (editable)
+            searchExact(c, word, i, path, found, visited);
+
+        if (i < word.size())
+        {
+            if (letter == word[i])
+                searchNear(c, word, i + 1, alphabet, path, found, visited);
+            else if (editable)
+                searchExact(c, word, i + 1, path, found, visited);
+
+            // Swapping word[i] and word[i+1], which only differs from
+            // matching both letters when they are different.
+            if (i + 1 < word.size() && letter == word[i+1] && word[i] != word[i+1])
+            {
+                unsigned int swapped = child(c, word[i]);
+                if (swapped != 0)
+                {
+                    visited++;
+                    path.push_back(word[i]);
+                    searchExact(swapped, word, i + 2, path, found, visited);
+                    path.pop_back();
+                }
+            }
+        }
+
+        path.pop_back();
+    }
+}
+
+
+void TrieSet::searchExact(
+    unsigned int node, std::string_view word, std::size_t i,
+    std::string& path, std::vector<std::string>& found,
+    unsigned int& visited) const
+{
+    std::size_t length = path.size();
+    for (; i < word.size(); i++)
+    {
+        node = child(node, word[i]);
+        visited++;
+        if (node == 0)
+        {
+            path.resize(length);
+            return;
+        }
+        path.push_back(word[i]);
+    }
+
+    if (nodes[node].terminal)
+        found.push_back(path);
+    path.resize(length);
+}
@@ -0,0 +1,154 @@
+#ifndef TRIESET_HPP
+#define TRIESET_HPP
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Set.hpp"
+#include "SetVersion.hpp"
+
+
+
+// TrieSet is a set of strings stored as a trie, one node per letter, with
+// all of the nodes kept in a single array.  Words that share a prefix share
+// the nodes for it, and after minimize() words that share a suffix share
+// those nodes too, turning the trie into a minimal DAWG.
+//
+// Besides membership, a TrieSet can find every word that is within one
+// edit of a given word in a single traversal, abandoning any prefix that
+// no word in the set starts with.
+class TrieSet : public Set<std::string>
+{
+public:
+    // Initializes a TrieSet to be empty.
+    TrieSet();
+
+    TrieSet(const TrieSet& s) = default;
+    TrieSet& operator=(const TrieSet& s) = default;
+
+    // Initializes a new TrieSet whose contents are moved from an expiring
+    // one, which is left empty but still usable.
+    TrieSet(TrieSet&& s);
+
+    // Assigns an expiring TrieSet into another.
+    TrieSet& operator=(TrieSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.  Adding to a minimized TrieSet first
+    // expands it back into a plain trie.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // This version of contains() accepts anything that converts to a
+    // std::string_view, without first converting it to a std::string.
+    template <typename K>
+    bool contains(const K& key) const;
+
+
+    // containsMany() looks up every key in keys, setting the corresponding
+    // entry of found to whether it is in the set.
+    template <typename K>
+    void containsMany(const std::vector<K>& keys, std::vector<bool>& found) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // version() returns a number that changes whenever the set's elements
+    // might have (see SetVersion.hpp).
+    unsigned long long version() const noexcept;
+
+
+    // nodeCount() returns the number of nodes in the trie, not counting
+    // its root.
+    unsigned int nodeCount() const noexcept;
+
+
+    // minimize() merges every group of identical subtries into one, so
+    // that common suffixes are stored once.  The set's contents do not
+    // change.
+    void minimize();
+
+
+    // nearWords() appends to found every word in the set that can be made
+    // from word by swapping two adjacent letters, inserting a letter,
+    // deleting a letter or replacing a letter, along with word itself if
+    // it is in the set.  Only letters in alphabet are inserted or used as
+    // replacements.  Each word is appended once.  The return value is the
+    // number of trie nodes that the search visited.
+    unsigned int nearWords(
+        std::string_view word, std::string_view alphabet,
+        std::vector<std::string>& found) const;
+
+
+private:
+    // Index 0 is always the root, which is nobody's child or sibling, so
+    // an index of 0 in firstChild or nextSibling means there is none.
+    // Siblings are kept in increasing order of letter.
+    struct Node
+    {
+        unsigned int firstChild = 0;
+        unsigned int nextSibling = 0;
+        char letter = '\0';
+        bool terminal = false;
+    };
+
+    // Maps a node's letter, terminal flag, child and sibling to the one
+    // copy of that node kept by minimize().
+    typedef std::map<std::tuple<char, bool, unsigned int, unsigned int>, unsigned int> Registry;
+
+    std::vector<Node> nodes;
+    unsigned int count;
+    bool minimized;
+    SetVersion contents;
+
+    bool find(std::string_view word) const;
+    unsigned int child(unsigned int node, char letter) const;
+    void expand();
+    unsigned int canonicalize(
+        unsigned int node, std::vector<unsigned int>& canonical,
+        Registry& registry, std::vector<Node>& minimal) const;
+    void collect(unsigned int node, std::string& path, std::vector<std::string>& words) const;
+    void searchNear(
+        unsigned int node, std::string_view word, std::size_t i,
+        std::string_view alphabet, std::string& path,
+        std::vector<std::string>& found, unsigned int& visited) const;
+    void searchExact(
+        unsigned int node, std::string_view word, std::size_t i,
+        std::string& path, std::vector<std::string>& found,
+        unsigned int& visited) const;
+};
+
+
+
+template <typename K>
+bool TrieSet::contains(const K& key) const
+{
+    return find(std::string_view{key});
+}
+
+
+template <typename K>
+void TrieSet::containsMany(const std::vector<K>& keys, std::vector<bool>& found) const
+{
+    found.assign(keys.size(), false);
+    for (std::size_t i = 0; i < keys.size(); i++)
+        found[i] = find(std::string_view{keys[i]});
+}
+
+
+
+#endif // TRIESET_HPP
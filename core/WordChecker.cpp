@@ -1,98 +1,213 @@
-
 #include "WordChecker.hpp"
-#include <iostream>
+#include "AVLSet.hpp"
+#include "FlatHashSet.hpp"
+#include "HashSet.hpp"
+#include "MappedSet.hpp"
+#include "PooledStringSet.hpp"
+
+
+
+class WordChecker::Checker
+{
+public:
+    virtual ~Checker() noexcept = default;
+    virtual std::unique_ptr<Checker> clone() const = 0;
+    virtual bool wordExists(const std::string& word) const = 0;
+    virtual std::vector<std::string> findSuggestions(const std::string& word) const = 0;
+    virtual std::vector<std::string> findTopSuggestions(const std::string& word, std::size_t k) const = 0;
+    virtual std::vector<std::string> findNearSuggestions(const std::string& word, unsigned int maxDistance) const = 0;
+    virtual SuggestionRange suggestions(const std::string& word) const = 0;
+    virtual void useDeletionIndex(const DeletionIndex* index) noexcept = 0;
+    virtual void useEditDistanceIndex(const EditDistanceIndex* index, std::chrono::nanoseconds budget) noexcept = 0;
+    virtual void useBloomFilter(const BloomFilter* filter) noexcept = 0;
+    virtual void useSuggestionCache(SuggestionCache* cache) noexcept = 0;
+    virtual void useWordFrequencies(const WordFrequencies* frequencies) noexcept = 0;
+    virtual std::vector<CheckResult> checkDocument(
+        const std::vector<std::string>& tokens, WorkStealingPool& pool) const = 0;
+};
+
+
+template <typename SetType>
+class WordChecker::CheckerFor : public WordChecker::Checker
+{
+public:
+    CheckerFor(const SetType& words)
+        : checker{words}
+    {
+    }
+
+    virtual std::unique_ptr<Checker> clone() const override
+    {
+        return std::make_unique<CheckerFor>(*this);
+    }
+
+    virtual bool wordExists(const std::string& word) const override
+    {
+        return checker.wordExists(word);
+    }
+
+    virtual std::vector<std::string> findSuggestions(const std::string& word) const override
+    {
+        return checker.findSuggestions(word);
+    }
+
+    virtual std::vector<std::string> findTopSuggestions(const std::string& word, std::size_t k) const override
+    {
+        return checker.findTopSuggestions(word, k);
+    }
+
+    virtual std::vector<std::string> findNearSuggestions(const std::string& word, unsigned int maxDistance) const override
+    {
+        return checker.findNearSuggestions(word, maxDistance);
+    }
+
+    virtual SuggestionRange suggestions(const std::string& word) const override
+    {
+        return checker.suggestions(word);
+    }
+
+    virtual void useDeletionIndex(const DeletionIndex* index) noexcept override
+    {
+        checker.useDeletionIndex(index);
+    }
+
+    virtual void useEditDistanceIndex(const EditDistanceIndex* index, std::chrono::nanoseconds budget) noexcept override
+    {
+        checker.useEditDistanceIndex(index, budget);
+    }
+
+    virtual void useBloomFilter(const BloomFilter* filter) noexcept override
+    {
+        checker.useBloomFilter(filter);
+    }
+
+    virtual void useSuggestionCache(SuggestionCache* cache) noexcept override
+    {
+        checker.useSuggestionCache(cache);
+    }
+
+    virtual void useWordFrequencies(const WordFrequencies* frequencies) noexcept override
+    {
+        checker.useWordFrequencies(frequencies);
+    }
+
+    virtual std::vector<CheckResult> checkDocument(
+        const std::vector<std::string>& tokens, WorkStealingPool& pool) const override
+    {
+        return checker.checkDocument(tokens, pool);
+    }
+
+private:
+    BasicWordChecker<SetType> checker;
+};
 
 
 WordChecker::WordChecker(const Set<std::string>& words)
-    : words{words}
+{
+    if (auto s = dynamic_cast<const HashSet<std::string>*>(&words))
+        checker = std::make_unique<CheckerFor<HashSet<std::string>>>(*s);
+    else if (auto s = dynamic_cast<const HashSet<std::string, FunctionHash<std::string>>*>(&words))
+        checker = std::make_unique<CheckerFor<HashSet<std::string, FunctionHash<std::string>>>>(*s);
+    else if (auto s = dynamic_cast<const HashSet<std::string, PolynomialHash>*>(&words))
+        checker = std::make_unique<CheckerFor<HashSet<std::string, PolynomialHash>>>(*s);
+    else if (auto s = dynamic_cast<const FlatHashSet<std::string>*>(&words))
+        checker = std::make_unique<CheckerFor<FlatHashSet<std::string>>>(*s);
+    else if (auto s = dynamic_cast<const FlatHashSet<std::string, FunctionHash<std::string>>*>(&words))
+        checker = std::make_unique<CheckerFor<FlatHashSet<std::string, FunctionHash<std::string>>>>(*s);
+    else if (auto s = dynamic_cast<const FlatHashSet<std::string, PolynomialHash>*>(&words))
+        checker = std::make_unique<CheckerFor<FlatHashSet<std::string, PolynomialHash>>>(*s);
+    else if (auto s = dynamic_cast<const AVLSet<std::string>*>(&words))
+        checker = std::make_unique<CheckerFor<AVLSet<std::string>>>(*s);
+    else if (auto s = dynamic_cast<const MappedSet*>(&words))
+        checker = std::make_unique<CheckerFor<MappedSet>>(*s);
+    else if (auto s = dynamic_cast<const PooledStringSet*>(&words))
+        checker = std::make_unique<CheckerFor<PooledStringSet>>(*s);
+    else if (auto s = dynamic_cast<const TrieSet*>(&words))
+        checker = std::make_unique<CheckerFor<TrieSet>>(*s);
+    else
+        checker = std::make_unique<CheckerFor<Set<std::string>>>(words);
+}
+
+
+WordChecker::~WordChecker() noexcept = default;
+
+
+WordChecker::WordChecker(const WordChecker& c)
+    : checker{c.checker->clone()}
 {
 }
 
 
+WordChecker& WordChecker::operator=(const WordChecker& c)
+{
+    if (this != &c)
+        checker = c.checker->clone();
+    return *this;
+}
+
+
 bool WordChecker::wordExists(const std::string& word) const
 {
-    return words.contains(word);
+    return checker->wordExists(word);
 }
 
 
 std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
 {
-    std::vector<std::string> suggest;
-    swapAdjacent(word, suggest);
-    addChars(word,suggest);
-    delEach(word,suggest);
-	repChar(word,suggest);
-    splitWord(word, suggest);
-    return suggest;
+    return checker->findSuggestions(word);
 }
 
-void WordChecker::swapAdjacent(const std::string& word, std::vector<std::string>& suggest) const
+
+std::vector<std::string> WordChecker::findTopSuggestions(const std::string& word, std::size_t k) const
 {
-    for(int i = 0; i < word.size()-1; i++)
-    {
-        std::string s = word;
-        std::swap(s[i],s[i+1]);
-        if(words.contains(s))
-            suggest.push_back(s);
-    }
+    return checker->findTopSuggestions(word, k);
 }
 
 
-void WordChecker::addChars(const std::string& word, std::vector<std::string>& suggest) const
-{
-    std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYX";
-    for(int i = 1; i < word.size(); i++)
-	{
-		std::string s = word;
-        s.insert(i, "0");
-        for(char j = 0; j < alphabet.size(); j++)
-        {   
-			s[i] = alphabet[j];
-            if(words.contains(s))
-                suggest.push_back(s);
-        }
-	}
+std::vector<std::string> WordChecker::findNearSuggestions(const std::string& word, unsigned int maxDistance) const
+{
+    return checker->findNearSuggestions(word, maxDistance);
 }
 
 
-void WordChecker::delEach(const std::string& word, std::vector<std::string>& suggest) const
+SuggestionRange WordChecker::suggestions(const std::string& word) const
 {
-    for(int i = 0; i < word.size(); i++)
-    {
-		if(word[i] == word[i+1] && i < word.size()-1)
-        	continue;
-        std::string s = word;
-        s.erase(s.begin()+i);
-        if(words.contains(s))
-            suggest.push_back(s);
-    }
+    return checker->suggestions(word);
 }
 
-void WordChecker::repChar(const std::string& word, std::vector<std::string>& suggest) const
+
+void WordChecker::useDeletionIndex(const DeletionIndex* index) noexcept
 {
-	std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYX";
-	for(int i = 0; i < word.size(); i++)
-    {
-		std::string s = word;
-        for(char j = 0; j < alphabet.size(); j++)
-        {
-           	s[i] = alphabet[j]; 
-            if(words.contains(s))
-                suggest.push_back(s);
-        }
-    }
+    checker->useDeletionIndex(index);
+}
+
+
+void WordChecker::useEditDistanceIndex(const EditDistanceIndex* index, std::chrono::nanoseconds budget) noexcept
+{
+    checker->useEditDistanceIndex(index, budget);
+}
+
+
+void WordChecker::useBloomFilter(const BloomFilter* filter) noexcept
+{
+    checker->useBloomFilter(filter);
 }
 
-void WordChecker::splitWord(const std::string& word, std::vector<std::string>& suggest) const
-{
-	for(int i = 1; i < word.size(); i++)
-	{
-		if(words.contains(word.substr(0,i)))
-			if(words.contains(word.substr(i)))
-			{
-                std::string s = word;
-                s.insert(i, " ");
-                suggest.push_back(s);
-			}
-	}
+
+void WordChecker::useSuggestionCache(SuggestionCache* cache) noexcept
+{
+    checker->useSuggestionCache(cache);
+}
+
+
+void WordChecker::useWordFrequencies(const WordFrequencies* frequencies) noexcept
+{
+    checker->useWordFrequencies(frequencies);
+}
+
+
+std::vector<WordChecker::CheckResult> WordChecker::checkDocument(
+    const std::vector<std::string>& tokens, WorkStealingPool& pool) const
+{
+    return checker->checkDocument(tokens, pool);
 }
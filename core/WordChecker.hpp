@@ -1,34 +1,126 @@
 #ifndef WORDCHECKER_HPP
 #define WORDCHECKER_HPP
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
+#include "BasicWordChecker.hpp"
 #include "Set.hpp"
 
 
 
+// A WordChecker checks words against any Set<std::string>.  It finds out
+// the set's concrete type when it is constructed and hands the work to a
+// BasicWordChecker for that type, so that the only virtual call is the one
+// into the checker, not one per candidate spelling.  Sets of a type it
+// does not know are checked through their virtual interface.
 class WordChecker
 {
+public:
+    typedef ::CheckResult CheckResult;
+
 public:
     WordChecker(const Set<std::string>& words);
 
+    ~WordChecker() noexcept;
+
+    WordChecker(const WordChecker& c);
+    WordChecker& operator=(const WordChecker& c);
+
     // wordExists() returns true if the given word is spelled correctly,
     // false otherwise.
     bool wordExists(const std::string& word) const;
 
 
     // findSuggestions() returns a vector containing suggested alternative
-    // spellings for the given word.
+    // spellings for the given word.  When the words are in a TrieSet, the
+    // swaps, insertions, deletions and replacements are all found by one
+    // search of the trie rather than by probing for every candidate.
     std::vector<std::string> findSuggestions(const std::string& word) const;
 
 
+    // findTopSuggestions() returns at most k of the suggestions that
+    // findSuggestions() would, best first and each only once, leaving out
+    // the word itself.  They are ranked by the cost of the edit that
+    // makes them from the word, then by their frequencies if a table was
+    // given to useWordFrequencies(), then alphabetically.  Generation
+    // stops early once k suggestions are found that nothing generated
+    // later could outrank.
+    std::vector<std::string> findTopSuggestions(const std::string& word, std::size_t k) const;
+
+
+    // findNearSuggestions() returns the words within maxDistance edits of
+    // the given word, leaving out the word itself, nearest first, then by
+    // their frequencies if a table was given to useWordFrequencies(), then
+    // alphabetically.  They are found by scanning the index given to
+    // useEditDistanceIndex(); a scan that runs out of its budget returns
+    // what it found by then.  Without an index, or for a word longer than
+    // the index's MAX_WORD_LENGTH, all of findTopSuggestions()'s
+    // suggestions are returned.
+    std::vector<std::string> findNearSuggestions(const std::string& word, unsigned int maxDistance = 2) const;
+
+
+    // suggestions() returns a range that yields the same suggestions as
+    // findSuggestions(), in the same order, finding them one kind of edit
+    // at a time as the range is iterated, so that a caller that stops
+    // early does not pay for the rest.  The range must not outlive the
+    // checker.
+    SuggestionRange suggestions(const std::string& word) const;
+
+
+    // useDeletionIndex() makes findSuggestions() look up near words in the
+    // given index, which must hold the same words as the set, instead of
+    // generating and probing candidates.  The suggestions are the same
+    // either way; the index trades memory for lower latency.  Passing
+    // nullptr goes back to generating candidates.
+    void useDeletionIndex(const DeletionIndex* index) noexcept;
+
+
+    // useEditDistanceIndex() gives findNearSuggestions() an index to scan,
+    // which must hold the same words as the set, and the time it may take
+    // over each word; a budget of zero means no limit.  Passing nullptr
+    // stops using an index.
+    void useEditDistanceIndex(
+        const EditDistanceIndex* index,
+        std::chrono::nanoseconds budget = EditDistanceIndex::DEFAULT_BUDGET) noexcept;
+
+
+    // useBloomFilter() makes the checker test every candidate spelling
+    // against the given filter, which must hold every word in the set, and
+    // only look up in the set those that pass.  Passing nullptr goes back
+    // to looking up every candidate.
+    void useBloomFilter(const BloomFilter* filter) noexcept;
+
+
+    // useSuggestionCache() makes findSuggestions() look for the word in the
+    // given cache first, and add what it finds there when the word is not
+    // in it.  The cache may be shared by many checkers, on many threads
+    // and on different sets.  Passing nullptr stops using a cache.
+    void useSuggestionCache(SuggestionCache* cache) noexcept;
+
+
+    // useWordFrequencies() makes findTopSuggestions() rank suggestions of
+    // equal cost by their frequencies in the given table.  Passing nullptr
+    // ranks them alphabetically.
+    void useWordFrequencies(const WordFrequencies* frequencies) noexcept;
+
+
+    // checkDocument() checks every token using the given pool's threads,
+    // returning one CheckResult per token in the same order as the tokens.
+    // Suggestions are only found for tokens that are not words.
+    std::vector<CheckResult> checkDocument(
+        const std::vector<std::string>& tokens, WorkStealingPool& pool) const;
+
+
 private:
-    const Set<std::string>& words;
-	void swapAdjacent(const std::string& word, std::vector<std::string>& suggest) const;
-	void addChars(const std::string& word, std::vector<std::string>& suggest) const;
-	void delEach(const std::string& word, std::vector<std::string>& suggest) const;
-	void repChar(const std::string& word, std::vector<std::string>& suggest) const;
-	void splitWord(const std::string& word, std::vector<std::string>& suggest) const;
+    // A Checker is a BasicWordChecker with its set's type erased.
+    class Checker;
+
+    template <typename SetType>
+    class CheckerFor;
+
+    std::unique_ptr<Checker> checker;
 };
 
 
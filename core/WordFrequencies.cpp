@@ -0,0 +1,20 @@
+#include "WordFrequencies.hpp"
+
+
+void WordFrequencies::add(const std::string& word, std::uint64_t frequency)
+{
+    frequencies[word] = frequency;
+}
+
+
+std::uint64_t WordFrequencies::frequency(const std::string& word) const
+{
+    auto i = frequencies.find(word);
+    return i == frequencies.end() ? 0 : i->second;
+}
+
+
+std::size_t WordFrequencies::size() const noexcept
+{
+    return frequencies.size();
+}
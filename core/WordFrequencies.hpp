@@ -0,0 +1,38 @@
+#ifndef WORDFREQUENCIES_HPP
+#define WORDFREQUENCIES_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "HashPolicies.hpp"
+
+
+
+// A WordFrequencies table records how often each word of a dictionary
+// occurs in ordinary text, so that among equally close suggestions the
+// more common words can be offered first.  Words it does not know have a
+// frequency of zero.
+class WordFrequencies
+{
+public:
+    // add() records the frequency of a word, replacing any recorded
+    // before.
+    void add(const std::string& word, std::uint64_t frequency);
+
+
+    // frequency() returns the frequency recorded for the given word, or 0
+    // if none was.
+    std::uint64_t frequency(const std::string& word) const;
+
+
+    // size() returns the number of words with a recorded frequency.
+    std::size_t size() const noexcept;
+
+
+private:
+    std::unordered_map<std::string, std::uint64_t, StringHash> frequencies;
+};
+
+
+
+#endif // WORDFREQUENCIES_HPP
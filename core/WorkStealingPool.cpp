@@ -0,0 +1,160 @@
+#include "WorkStealingPool.hpp"
+
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+    : body{nullptr}, generation{0}, running{0}, stopping{false}
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    for (unsigned int i = 0; i < threads; i++)
+        shares.push_back(std::make_unique<Share>());
+
+    // The thread calling parallelFor() does the work of share 0.
+    for (unsigned int i = 1; i < threads; i++)
+        workers.emplace_back(&WorkStealingPool::work, this, i);
+}
+
+
+WorkStealingPool::~WorkStealingPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+
+unsigned int WorkStealingPool::threadCount() const noexcept
+{
+    return shares.size();
+}
+
+
+void WorkStealingPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body)
+{
+    std::lock_guard<std::mutex> loop{loopMutex};
+
+    std::size_t threads = shares.size();
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        std::lock_guard<std::mutex> lock{shares[i]->mutex};
+        shares[i]->begin = count * i / threads;
+        shares[i]->end = count * (i + 1) / threads;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        this->body = &body;
+        failure = nullptr;
+        running = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    runShare(0);
+
+    std::unique_lock<std::mutex> lock{mutex};
+    finished.wait(lock, [this] { return running == 0; });
+    this->body = nullptr;
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+
+void WorkStealingPool::work(unsigned int self)
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runShare(self);
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (--running == 0)
+            finished.notify_one();
+    }
+}
+
+
+void WorkStealingPool::runShare(unsigned int self)
+{
+    std::size_t index;
+    while (take(self, index) || (steal(self) && take(self, index)))
+    {
+        try
+        {
+            (*body)(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!failure)
+                failure = std::current_exception();
+        }
+    }
+}
+
+
+bool WorkStealingPool::take(unsigned int self, std::size_t& index)
+{
+    Share& share = *shares[self];
+    std::lock_guard<std::mutex> lock{share.mutex};
+    if (share.begin == share.end)
+        return false;
+    index = share.begin++;
+    return true;
+}
+
+
+bool WorkStealingPool::steal(unsigned int self)
+{
+    // Keep trying the share with the most left in it until there is
+    // nothing left to steal; another thief may empty it first.
+    while (true)
+    {
+        unsigned int victim = self;
+        std::size_t most = 0;
+        for (unsigned int i = 0; i < shares.size(); i++)
+        {
+            if (i == self)
+                continue;
+            std::lock_guard<std::mutex> lock{shares[i]->mutex};
+            if (shares[i]->end - shares[i]->begin > most)
+            {
+                most = shares[i]->end - shares[i]->begin;
+                victim = i;
+            }
+        }
+        if (victim == self)
+            return false;
+
+        std::size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock{shares[victim]->mutex};
+            std::size_t left = shares[victim]->end - shares[victim]->begin;
+            if (left == 0)
+                continue;
+            end = shares[victim]->end;
+            begin = end - (left + 1) / 2;
+            shares[victim]->end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock{shares[self]->mutex};
+        shares[self]->begin = begin;
+        shares[self]->end = end;
+        return true;
+    }
+}
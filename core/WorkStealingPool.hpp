@@ -0,0 +1,82 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+// A WorkStealingPool runs loops in parallel on a fixed set of threads.
+// Each thread starts with an equal share of a loop's iterations; a thread
+// that finishes its share early steals half of what remains of the
+// largest share still running, so iterations that take much longer than
+// others do not leave the other threads idle.
+class WorkStealingPool
+{
+public:
+    // Initializes a pool that runs loops on the given number of threads,
+    // including the one that calls parallelFor().  A count of zero uses
+    // one thread per hardware thread.
+    explicit WorkStealingPool(unsigned int threads = 0);
+
+    // Stops and joins the pool's threads.
+    ~WorkStealingPool() noexcept;
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+
+    // threadCount() returns the number of threads that run each loop.
+    unsigned int threadCount() const noexcept;
+
+
+    // parallelFor() calls body(i) for every i from 0 up to count, spread
+    // across the pool's threads, and returns once every call has finished.
+    // If any call throws, the first exception is rethrown here after the
+    // rest of the loop has run.  Loops cannot be nested.  Calls from
+    // several threads at once are safe, but run one loop at a time, each
+    // waiting for the loops called before it to finish.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+
+private:
+    // The iterations from begin up to end that belong to one thread.  Its
+    // owner takes iterations from the front; thieves take from the back.
+    struct Share
+    {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Share>> shares;
+
+    // Held for the whole of each parallelFor(), since there is only one
+    // loop's worth of state.
+    std::mutex loopMutex;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(std::size_t)>* body;
+    std::exception_ptr failure;
+    unsigned long long generation;
+    unsigned int running;
+    bool stopping;
+
+    void work(unsigned int self);
+    void runShare(unsigned int self);
+    bool take(unsigned int self, std::size_t& index);
+    bool steal(unsigned int self);
+};
+
+
+
+#endif // WORKSTEALINGPOOL_HPP